@@ -0,0 +1,24 @@
+#pragma once
+
+#include "esphome/core/automation.h"
+#include "esphome/core/helpers.h"
+#include "greeir.h"
+
+namespace esphome
+{
+  namespace greeir
+  {
+
+    /// Programs the unit's onboard timer; a duration of 0 cancels it. Durations round up to whole
+    /// minutes, so a short one still sets the timer.
+    template <typename... Ts>
+    class GreeSetTimerAction : public Action<Ts...>, public Parented<GreeIRClimate>
+    {
+    public:
+      TEMPLATABLE_VALUE(uint32_t, duration)
+
+      void play(Ts... x) override { this->parent_->set_timer((this->duration_.value(x...) + 59999) / 60000); }
+    };
+
+  } // namespace greeir
+} // namespace esphome
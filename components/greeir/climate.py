@@ -1,14 +1,28 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
-from esphome.components import climate_ir
-from esphome.const import CONF_ID, CONF_MODEL, CONF_REPEAT
+from esphome import automation
+from esphome.components import climate_ir, sensor
+from esphome.const import (
+    CONF_DURATION,
+    CONF_ID,
+    CONF_MODEL,
+    CONF_REPEAT,
+    CONF_SENSOR,
+    CONF_UPDATE_INTERVAL,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
+    UNIT_MILLISECOND,
+)
 
 # AUTO_LOAD = ["climate_ir"]
-AUTO_LOAD = ["climate_ir"]
+AUTO_LOAD = ["climate_ir", "sensor"]
 CODEOWNERS = ["@amirlanesman"]
 
 greeir_ns = cg.esphome_ns.namespace("greeir")
 GreeIRClimate = greeir_ns.class_("GreeIRClimate", climate_ir.ClimateIR)
+GreeIRModelClimate = greeir_ns.class_("GreeIRModelClimate", GreeIRClimate)
+GreeSetTimerAction = greeir_ns.class_("GreeSetTimerAction", automation.Action)
 
 # Gree model variants
 GreeIRModel = greeir_ns.enum("GreeIRModel", is_class=True)
@@ -18,15 +32,101 @@ GREE_MODELS = {
     "YBOFB": GreeIRModel.YBOFB,
     "YAC1FB9": GreeIRModel.YAC1FB9,
     "YT1F": GreeIRModel.YT1F,
+    "AUTO": GreeIRModel.AUTO,
 }
 
 CONF_WIFI_FUNCTION = "wifi_function"
 CONF_CHECK_CHECKSUM = "check_checksum"
 CONF_SET_MODES = "set_modes"
+CONF_COALESCE_WINDOW = "coalesce_window"
+CONF_KEEPALIVE_INTERVAL = "keepalive_interval"
+CONF_DEDUP_WINDOW = "dedup_window"
+CONF_ASYNC_TRANSMIT = "async_transmit"
+CONF_DIAGNOSTICS = "diagnostics"
+CONF_CALIBRATION = "calibration"
+CONF_GROUP_MEMBERS = "group_members"
+CONF_RECORD_CAPTURES = "record_captures"
+CONF_RECORD_REJECTED = "record_rejected"
+CONF_RESTORE_LAST_SENT = "restore_last_sent"
+CONF_FAST_BOOT = "fast_boot"
+CONF_IFEEL = "ifeel"
+CONF_DELTA = "delta"
+CONF_MIN_INTERVAL = "min_interval"
+CONF_MAX_INTERVAL = "max_interval"
+
+IFEEL_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_DELTA, default=0.5): cv.positive_float,
+        cv.Optional(
+            CONF_MIN_INTERVAL, default="1min"
+        ): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_MAX_INTERVAL): cv.positive_time_period_milliseconds,
+    }
+)
+
+UNIT_MICROSECOND = "µs"
+
+GreeDiagnostic = greeir_ns.enum("GreeDiagnostic", is_class=True)
+_COUNTER_SCHEMA = sensor.sensor_schema(
+    accuracy_decimals=0,
+    state_class=STATE_CLASS_TOTAL_INCREASING,
+    entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+)
+_TIME_SCHEMA = sensor.sensor_schema(
+    unit_of_measurement=UNIT_MICROSECOND,
+    accuracy_decimals=0,
+    state_class=STATE_CLASS_MEASUREMENT,
+    entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+)
+DIAGNOSTIC_SENSORS = {
+    "prefilter_rejects": (GreeDiagnostic.PREFILTER_REJECTS, _COUNTER_SCHEMA),
+    "header_errors": (GreeDiagnostic.HEADER_ERRORS, _COUNTER_SCHEMA),
+    "block_1_errors": (GreeDiagnostic.BLOCK_1_ERRORS, _COUNTER_SCHEMA),
+    "footer_errors": (GreeDiagnostic.FOOTER_ERRORS, _COUNTER_SCHEMA),
+    "message_space_errors": (GreeDiagnostic.MESSAGE_SPACE_ERRORS, _COUNTER_SCHEMA),
+    "block_2_errors": (GreeDiagnostic.BLOCK_2_ERRORS, _COUNTER_SCHEMA),
+    "checksum_errors": (GreeDiagnostic.CHECKSUM_ERRORS, _COUNTER_SCHEMA),
+    "frames_decoded": (GreeDiagnostic.FRAMES_DECODED, _COUNTER_SCHEMA),
+    "frames_transmitted": (GreeDiagnostic.FRAMES_TRANSMITTED, _COUNTER_SCHEMA),
+    "airtime": (
+        GreeDiagnostic.AIRTIME,
+        sensor.sensor_schema(
+            unit_of_measurement=UNIT_MILLISECOND,
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+    ),
+    "decode_time_min": (GreeDiagnostic.DECODE_TIME_MIN, _TIME_SCHEMA),
+    "decode_time_avg": (GreeDiagnostic.DECODE_TIME_AVG, _TIME_SCHEMA),
+    "decode_time_max": (GreeDiagnostic.DECODE_TIME_MAX, _TIME_SCHEMA),
+    "encode_time_min": (GreeDiagnostic.ENCODE_TIME_MIN, _TIME_SCHEMA),
+    "encode_time_avg": (GreeDiagnostic.ENCODE_TIME_AVG, _TIME_SCHEMA),
+    "encode_time_max": (GreeDiagnostic.ENCODE_TIME_MAX, _TIME_SCHEMA),
+}
+
+DIAGNOSTICS_SCHEMA = cv.Schema(
+    {
+        cv.Optional(
+            CONF_UPDATE_INTERVAL, default="60s"
+        ): cv.positive_time_period_milliseconds,
+        **{
+            cv.Optional(key): schema
+            for key, (_, schema) in DIAGNOSTIC_SENSORS.items()
+        },
+    }
+)
+
+
+def _validate_ifeel(config):
+    if CONF_IFEEL in config and CONF_SENSOR not in config:
+        raise cv.Invalid(f"'{CONF_IFEEL}' reports the '{CONF_SENSOR}' reading, so it needs one")
+    return config
+
 
 CONFIG_SCHEMA = climate_ir.CLIMATE_IR_WITH_RECEIVER_SCHEMA.extend(
     {
-        cv.GenerateID(): cv.declare_id(GreeIRClimate),
+        cv.GenerateID(): cv.declare_id(GreeIRModelClimate),
         cv.Optional(CONF_MODEL, default=GREE_MODELS["GENERIC"]): cv.enum(
             GREE_MODELS, upper=True
         ),
@@ -34,18 +134,87 @@ CONFIG_SCHEMA = climate_ir.CLIMATE_IR_WITH_RECEIVER_SCHEMA.extend(
         cv.Optional(CONF_CHECK_CHECKSUM, default=False): cv.boolean,
         cv.Optional(CONF_SET_MODES, default=False): cv.boolean,
         cv.Optional(CONF_REPEAT, default=1): cv.int_range(min=1, max=100),
+        cv.Optional(
+            CONF_COALESCE_WINDOW, default="0ms"
+        ): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_KEEPALIVE_INTERVAL): cv.positive_time_period_milliseconds,
+        cv.Optional(
+            CONF_DEDUP_WINDOW, default="1s"
+        ): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_ASYNC_TRANSMIT, default=False): cv.boolean,
+        cv.Optional(CONF_IFEEL): IFEEL_SCHEMA,
+        cv.Optional(CONF_DIAGNOSTICS): DIAGNOSTICS_SCHEMA,
+        cv.Optional(CONF_CALIBRATION, default=False): cv.boolean,
+        cv.Optional(CONF_GROUP_MEMBERS): cv.ensure_list(cv.use_id(GreeIRClimate)),
+        cv.Optional(CONF_RECORD_CAPTURES, default=0): cv.int_range(min=0, max=64),
+        cv.Optional(CONF_RECORD_REJECTED, default=False): cv.boolean,
+        cv.Optional(CONF_RESTORE_LAST_SENT, default=True): cv.boolean,
+        cv.Optional(CONF_FAST_BOOT, default=False): cv.boolean,
     }
-)
+).add_extra(_validate_ifeel)
 
 
 async def to_code(config):
 
-    var = cg.new_Pvariable(config[CONF_ID])
+    # Instantiate the codec of the configured model only
+    var = cg.new_Pvariable(config[CONF_ID], cg.TemplateArguments(config[CONF_MODEL]))
 
-    cg.add(var.set_model(config[CONF_MODEL]))
     cg.add(var.set_wifi_function(config[CONF_WIFI_FUNCTION]))
     cg.add(var.set_check_checksum(config[CONF_CHECK_CHECKSUM]))
     cg.add(var.set_set_modes(config[CONF_SET_MODES]))
     cg.add(var.set_repeat(config[CONF_REPEAT]))
+    cg.add(var.set_coalesce_window(config[CONF_COALESCE_WINDOW]))
+    cg.add(var.set_dedup_window(config[CONF_DEDUP_WINDOW]))
+    cg.add(var.set_async_transmit(config[CONF_ASYNC_TRANSMIT]))
+    if CONF_KEEPALIVE_INTERVAL in config:
+        cg.add(var.set_keepalive_interval(config[CONF_KEEPALIVE_INTERVAL]))
+    if CONF_IFEEL in config:
+        ifeel = config[CONF_IFEEL]
+        cg.add(
+            var.set_ifeel(
+                ifeel[CONF_DELTA],
+                ifeel[CONF_MIN_INTERVAL],
+                ifeel.get(CONF_MAX_INTERVAL, 0),
+            )
+        )
+
+    cg.add(var.set_restore_last_sent(config[CONF_RESTORE_LAST_SENT]))
+    if config[CONF_FAST_BOOT]:
+        cg.add_define("USE_GREEIR_FAST_BOOT")
+    if config[CONF_RECORD_CAPTURES] > 0:
+        cg.add(var.set_record_captures(config[CONF_RECORD_CAPTURES]))
+        if config[CONF_RECORD_REJECTED]:
+            cg.add(var.set_record_rejected(True))
+    for member_id in config.get(CONF_GROUP_MEMBERS, []):
+        member = await cg.get_variable(member_id)
+        cg.add(var.add_group_member(member))
+    cg.add(var.set_calibration(config[CONF_CALIBRATION]))
+    if CONF_DIAGNOSTICS in config:
+        diagnostics = config[CONF_DIAGNOSTICS]
+        cg.add(var.set_diagnostics_interval(diagnostics[CONF_UPDATE_INTERVAL]))
+        for key, (diagnostic, _) in DIAGNOSTIC_SENSORS.items():
+            if key in diagnostics:
+                sens = await sensor.new_sensor(diagnostics[key])
+                cg.add(var.set_diagnostic_sensor(diagnostic, sens))
 
     await climate_ir.register_climate_ir(var, config)
+
+
+@automation.register_action(
+    "greeir.set_timer",
+    GreeSetTimerAction,
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.use_id(GreeIRClimate),
+            cv.Required(CONF_DURATION): cv.templatable(
+                cv.positive_time_period_milliseconds
+            ),
+        }
+    ),
+)
+async def set_timer_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    duration = await cg.templatable(config[CONF_DURATION], args, cg.uint32)
+    cg.add(var.set_duration(duration))
+    return var
@@ -0,0 +1,1246 @@
+#pragma once
+
+// Hardware-free Gree IR codec: frame layout, checksum, pulse encoding and decoding.
+// Depends only on the C++ standard library, so it also builds on a plain host.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace esphome
+{
+  namespace greeir
+  {
+
+    // Temperature constants
+    const uint8_t GREE_TEMP_MIN = 16; // °C
+    const uint8_t GREE_TEMP_MAX = 30; // °C
+
+    // IR timing constants
+    const uint32_t GREE_IR_FREQUENCY = 38000;
+    const uint32_t GREE_HEADER_MARK = 9000;
+    const uint32_t GREE_HEADER_SPACE = 4000;
+    const uint32_t GREE_BIT_MARK = 620;
+    const uint32_t GREE_ONE_SPACE = 1600;
+    const uint32_t GREE_ZERO_SPACE = 540;
+    const uint32_t GREE_MESSAGE_SPACE = 19000;
+
+    // YAC1FB9 variant timing (some Gree models)
+    const uint32_t GREE_YAC1FB9_HEADER_SPACE = 4500;
+    const uint32_t GREE_YAC1FB9_MESSAGE_SPACE = 19800;
+    const uint32_t GREE_YAC_HEADER_MARK = 6000;
+    const uint32_t GREE_YAC_HEADER_SPACE = 3000;
+    const uint32_t GREE_YAC_BIT_MARK = 650;
+
+    // State frame size in bytes
+    const uint8_t GREE_STATE_FRAME_SIZE = 8;
+    const uint8_t GREE_BLOCK_FOOTER_SIZE = 3;
+    // Default receive tolerance in percent, matching the remote_receiver default
+    const uint8_t GREE_TOLERANCE = 25;
+    // Pulse items per frame: header, 32 bits, footer, message space, 32 bits, message space
+    const size_t GREE_FRAME_ITEMS = 2 + 64 + GREE_BLOCK_FOOTER_SIZE * 2 + 2 + 64 + 2;
+
+    // Shortest accepted capture: one frame, allowing for a cut-off trailing space or lost edges
+    const size_t GREE_MIN_CAPTURE_ITEMS = 130;
+    // Repeats of a frame in one capture that are combined by majority vote
+    const uint8_t GREE_MAX_CAPTURE_FRAMES = 8;
+    // Index of the mark preceding the message space between the two blocks
+    const size_t GREE_MESSAGE_SPACE_INDEX = 2 + 32 * 2 + GREE_BLOCK_FOOTER_SIZE * 2;
+
+    // iFeel room-temperature report: header, temperature byte, signature byte, trailing mark
+    const uint8_t GREE_IFEEL_SIGNATURE = 0xA5;
+    const uint32_t GREE_IFEEL_HEADER_MARK = 6000;
+    const uint32_t GREE_IFEEL_HEADER_SPACE = 3000;
+    const size_t GREE_IFEEL_ITEMS = 2 + 16 * 2 + 2;
+
+    /// One encoded frame in RawTimings form (marks positive, spaces negative).
+    using GreeFrameTimings = std::array<int32_t, GREE_FRAME_ITEMS>;
+
+    // Mode constants
+    const uint8_t GREE_MODE_AUTO = 0;
+    const uint8_t GREE_MODE_COOL = 1;
+    const uint8_t GREE_MODE_DRY = 2;
+    const uint8_t GREE_MODE_FAN = 3;
+    const uint8_t GREE_MODE_HEAT = 4;
+    const uint8_t GREE_MODE_ON = 8;
+    const uint8_t GREE_MODE_OFF = 0;
+    // Power constants
+    const uint8_t GREE_POWER_ON = 1;
+    const uint8_t GREE_POWER_OFF = 0;
+
+    // Fan speed constants
+    const uint8_t GREE_FAN_AUTO = 0;
+    const uint8_t GREE_FAN_LOW = 1;
+    const uint8_t GREE_FAN_MEDIUM = 2;
+    const uint8_t GREE_FAN_HIGH = 3;
+    const uint8_t GREE_FAN_TURBO = 0;
+    const uint8_t GREE_FAN_TURBO_BIT = 4;
+
+    // Swing constants - Vertical
+    const uint8_t GREE_VDIR_AUTO = 0;
+    const uint8_t GREE_VDIR_SWING = 1;
+    const uint8_t GREE_VDIR_UP = 2;
+    const uint8_t GREE_VDIR_MUP = 3;
+    const uint8_t GREE_VDIR_MIDDLE = 4;
+    const uint8_t GREE_VDIR_MDOWN = 5;
+    const uint8_t GREE_VDIR_DOWN = 6;
+    const uint8_t GREE_VDIR_MANUAL = 0;
+
+    // Swing constants - Horizontal
+    const uint8_t GREE_HDIR_AUTO = 0;
+    const uint8_t GREE_HDIR_SWING = 1;
+    const uint8_t GREE_HDIR_LEFT = 2;
+    const uint8_t GREE_HDIR_MLEFT = 3;
+    const uint8_t GREE_HDIR_MIDDLE = 4;
+    const uint8_t GREE_HDIR_MRIGHT = 5;
+    const uint8_t GREE_HDIR_RIGHT = 6;
+    const uint8_t GREE_HDIR_MANUAL = 0;
+
+    // Swing constants - Auto
+    const uint8_t GREE_SWING_AUTO = 0;
+    const uint8_t GREE_SWING_MANUAL = 1;
+
+    // Preset constants
+    const uint8_t GREE_PRESET_NONE = 0;
+    const uint8_t GREE_PRESET_SLEEP = 1;
+    const uint8_t GREE_PRESET_SLEEP_BIT = 0;
+
+    // Gree model variants
+    enum class GreeIRModel
+    {
+      GENERIC,
+      YAW1F,
+      YBOFB,
+      YAC1FB9,
+      YT1F,
+      AUTO, // detected from received frames
+    };
+
+    inline const char *gree_model_to_string(GreeIRModel model)
+    {
+      switch (model)
+      {
+      case GreeIRModel::GENERIC:
+        return "GENERIC";
+      case GreeIRModel::YAW1F:
+        return "YAW1F";
+      case GreeIRModel::YBOFB:
+        return "YBOFB";
+      case GreeIRModel::YAC1FB9:
+        return "YAC1FB9";
+      case GreeIRModel::YT1F:
+        return "YT1F";
+      case GreeIRModel::AUTO:
+        return "AUTO";
+      default:
+        return "UNKNOWN";
+      }
+    }
+
+    /// Pulse timings of a model variant, resolved at compile time.
+    /// The primary template holds the generic timings; variants override what differs.
+    template <GreeIRModel Model>
+    struct GreeTiming
+    {
+      static constexpr uint32_t HEADER_MARK = GREE_HEADER_MARK;
+      static constexpr uint32_t HEADER_SPACE = GREE_HEADER_SPACE;
+      static constexpr uint32_t BIT_MARK = GREE_BIT_MARK;
+      static constexpr uint32_t ONE_SPACE = GREE_ONE_SPACE;
+      static constexpr uint32_t ZERO_SPACE = GREE_ZERO_SPACE;
+      static constexpr uint32_t MESSAGE_SPACE = GREE_MESSAGE_SPACE;
+    };
+
+    template <>
+    struct GreeTiming<GreeIRModel::YAC1FB9> : GreeTiming<GreeIRModel::GENERIC>
+    {
+      static constexpr uint32_t HEADER_SPACE = GREE_YAC1FB9_HEADER_SPACE;
+      static constexpr uint32_t MESSAGE_SPACE = GREE_YAC1FB9_MESSAGE_SPACE;
+    };
+
+    template <>
+    struct GreeTiming<GreeIRModel::YAW1F> : GreeTiming<GreeIRModel::GENERIC>
+    {
+      static constexpr uint32_t HEADER_MARK = GREE_YAC_HEADER_MARK;
+      static constexpr uint32_t HEADER_SPACE = GREE_YAC_HEADER_SPACE;
+      static constexpr uint32_t BIT_MARK = GREE_YAC_BIT_MARK;
+    };
+
+    template <>
+    struct GreeTiming<GreeIRModel::YBOFB> : GreeTiming<GreeIRModel::YAW1F>
+    {
+    };
+
+    /// Timings of 16-byte Kelvinator units, the larger member of the family.
+    struct GreeKelvinatorTiming
+    {
+      static constexpr uint32_t HEADER_MARK = 9010;
+      static constexpr uint32_t HEADER_SPACE = 4505;
+      static constexpr uint32_t BIT_MARK = 680;
+      static constexpr uint32_t ONE_SPACE = 1530;
+      static constexpr uint32_t ZERO_SPACE = 510;
+      static constexpr uint32_t MESSAGE_SPACE = 19975;
+    };
+
+    /// One entry of a bidirectional climate <-> Gree protocol value table.
+    template <typename T>
+    struct GreeMapping
+    {
+      T climate;
+      uint8_t gree;
+    };
+
+    /// Look up the Gree value for a climate value, or `fallback` if it has none.
+    template <typename T, size_t N>
+    constexpr uint8_t gree_encode(const GreeMapping<T> (&table)[N], T value, uint8_t fallback)
+    {
+      for (size_t i = 0; i < N; i++)
+      {
+        if (table[i].climate == value)
+          return table[i].gree;
+      }
+      return fallback;
+    }
+
+    /// Look up the climate value for a Gree value. Returns false if it is unknown.
+    template <typename T, size_t N>
+    constexpr bool gree_decode(const GreeMapping<T> (&table)[N], uint8_t value, T &out)
+    {
+      for (size_t i = 0; i < N; i++)
+      {
+        if (table[i].gree == value)
+        {
+          out = table[i].climate;
+          return true;
+        }
+      }
+      return false;
+    }
+
+    /// True if every entry of `table` survives an encode followed by a decode.
+    /// Used in static_asserts so a table that can't round-trip fails the build.
+    template <typename T, size_t N>
+    constexpr bool gree_round_trips(const GreeMapping<T> (&table)[N])
+    {
+      for (size_t i = 0; i < N; i++)
+      {
+        T decoded = table[i].climate;
+        if (!gree_decode(table, gree_encode(table, table[i].climate, 0xFF), decoded) || decoded != table[i].climate)
+          return false;
+        for (size_t j = 0; j < i; j++)
+        {
+          if (table[j].gree == table[i].gree)
+            return false;
+        }
+      }
+      return true;
+    }
+
+    /// Protocol-level state carried by a frame, independent of ESPHome climate types.
+    struct GreeState
+    {
+      bool power{false};
+      uint8_t mode{GREE_MODE_AUTO};
+      uint8_t fan{GREE_FAN_AUTO};
+      uint8_t temperature{GREE_TEMP_MIN}; // °C
+      uint8_t swing_v{GREE_VDIR_MANUAL};
+      uint8_t swing_h{GREE_HDIR_MANUAL};
+      uint8_t swing_auto{GREE_SWING_MANUAL};
+      bool sleep{false};
+      bool model_a{false};
+      bool wifi{false};
+      bool light{true};
+      bool ifeel{false}; // unit uses the room temperature reported by iFeel messages
+      uint16_t timer{0};  // minutes until the unit toggles power by itself, 0 = off
+    };
+
+    // Longest onboard timer, in minutes; it counts in half hours
+    const uint16_t GREE_TIMER_MAX = 24 * 60;
+
+    const uint8_t kKelvinatorChecksumStart = 10;
+
+    /// Position of a field in a GreeFrame: bit offset from bit 0 of byte 0, and width in bits.
+    struct GreeField
+    {
+      uint8_t shift;
+      uint8_t width;
+    };
+
+    /// The 8-byte state frame held in one integer, byte 0 in the low bits (the order it is
+    /// sent in). Fields are accessed with shifts and masks, so the layout doesn't depend on
+    /// compiler bitfield ordering, no buffer is type-punned, and all of it is constexpr.
+    /// Field layout as documented by IRremoteESP8266.
+    class GreeFrame
+    {
+    public:
+      // Byte 0
+      static constexpr GreeField MODE{0, 3};
+      static constexpr GreeField POWER{3, 1};
+      static constexpr GreeField FAN{4, 2};
+      static constexpr GreeField SWING_AUTO{6, 1};
+      static constexpr GreeField SLEEP{7, 1};
+      // Byte 1
+      static constexpr GreeField TEMP{8, 4};
+      static constexpr GreeField TIMER_HALF_HR{12, 1};
+      static constexpr GreeField TIMER_TENS_HR{13, 2};
+      static constexpr GreeField TIMER_ENABLED{15, 1};
+      // Byte 2
+      static constexpr GreeField TIMER_HOURS{16, 4};
+      static constexpr GreeField TURBO{20, 1};
+      static constexpr GreeField LIGHT{21, 1};
+      static constexpr GreeField MODEL_A{22, 1}; // model==YAW1F
+      static constexpr GreeField XFAN{23, 1};
+      // Byte 3
+      static constexpr GreeField TEMP_EXTRA_DEGREE_F{26, 1};
+      static constexpr GreeField USE_FAHRENHEIT{27, 1};
+      static constexpr GreeField UNKNOWN_1{28, 4}; // value=0b0101
+      // Byte 4
+      static constexpr GreeField SWING_V{32, 4};
+      static constexpr GreeField SWING_H{36, 3};
+      // Byte 5
+      static constexpr GreeField DISPLAY_TEMP{40, 2};
+      static constexpr GreeField IFEEL{42, 1};
+      static constexpr GreeField UNKNOWN_2{43, 3}; // value = 0b100
+      static constexpr GreeField WIFI{46, 1};
+      // Byte 7
+      static constexpr GreeField ECONO{58, 1};
+      static constexpr GreeField SUM{60, 4};
+
+      constexpr GreeFrame() = default;
+      constexpr explicit GreeFrame(uint64_t raw) : raw_(raw) {}
+
+      constexpr uint64_t raw() const { return this->raw_; }
+
+      constexpr uint8_t get(GreeField field) const
+      {
+        return (this->raw_ >> field.shift) & ((1U << field.width) - 1);
+      }
+
+      constexpr GreeFrame &set(GreeField field, uint8_t value)
+      {
+        const uint64_t mask = ((uint64_t{1} << field.width) - 1) << field.shift;
+        this->raw_ = (this->raw_ & ~mask) | ((static_cast<uint64_t>(value) << field.shift) & mask);
+        return *this;
+      }
+
+      constexpr uint8_t get_byte(uint8_t index) const { return this->raw_ >> (index * 8); }
+      constexpr GreeFrame &set_byte(uint8_t index, uint8_t value) { return this->set({static_cast<uint8_t>(index * 8), 8}, value); }
+
+      /// Checksum over the low nibbles of bytes 0-3 and the high nibbles of bytes 4-6, plus
+      /// kKelvinatorChecksumStart, mod 16. The seven nibbles are masked into the byte lanes of
+      /// one word and summed with a single multiply (at most 105, so no lane overflows).
+      constexpr uint8_t calc_checksum() const
+      {
+        const uint32_t lanes = static_cast<uint32_t>(this->raw_ & 0x0F0F0F0FU) +
+                               static_cast<uint32_t>((this->raw_ >> 36) & 0x0F0F0FU);
+        return (kKelvinatorChecksumStart + ((lanes * 0x01010101U) >> 24)) & 0x0F;
+      }
+
+      constexpr bool is_checksum_valid() const { return this->get(SUM) == this->calc_checksum(); }
+      constexpr GreeFrame &update_checksum() { return this->set(SUM, this->calc_checksum()); }
+
+      constexpr bool operator==(const GreeFrame &other) const { return this->raw_ == other.raw_; }
+      constexpr bool operator!=(const GreeFrame &other) const { return this->raw_ != other.raw_; }
+
+    protected:
+      uint64_t raw_{0};
+    };
+
+    static_assert(GreeFrame().calc_checksum() == kKelvinatorChecksumStart, "empty frame checksum");
+    static_assert(GreeFrame(0xFFFFFFFFFFFFFFFFULL).calc_checksum() == ((kKelvinatorChecksumStart + 7 * 15) & 0x0F),
+                  "checksum sums seven nibbles");
+    static_assert(GreeFrame(0xFF0F0F0FF0F0F0F0ULL).calc_checksum() == kKelvinatorChecksumStart,
+                  "checksum ignores the high nibbles of bytes 0-3, the low nibbles of bytes 4-6 and byte 7");
+    static_assert(GreeFrame().set(GreeFrame::SWING_H, 0b111).raw() == 0x0000007000000000ULL, "SwingH is bits 36-38");
+    static_assert(GreeFrame(0xFFFFFFFFFFFFFFFFULL).set(GreeFrame::TEMP, 0).get_byte(1) == 0xF0, "Temp is the low nibble of byte 1");
+
+    /// Build the state frame, including its checksum.
+    constexpr GreeFrame encode_state(const GreeState &state)
+    {
+      const uint8_t temperature = state.temperature < GREE_TEMP_MIN   ? GREE_TEMP_MIN
+                                  : state.temperature > GREE_TEMP_MAX ? GREE_TEMP_MAX
+                                                                      : state.temperature;
+      GreeFrame frame;
+      frame.set(GreeFrame::POWER, state.power ? GREE_POWER_ON : GREE_POWER_OFF)
+          .set(GreeFrame::MODE, state.mode)
+          .set(GreeFrame::FAN, state.fan)
+          .set(GreeFrame::TEMP, temperature - GREE_TEMP_MIN)
+          .set(GreeFrame::SWING_AUTO, state.swing_auto)
+          .set(GreeFrame::SWING_V, state.swing_v)
+          .set(GreeFrame::SWING_H, state.swing_h)
+          .set(GreeFrame::SLEEP, state.sleep)
+          .set(GreeFrame::MODEL_A, state.model_a)
+          .set(GreeFrame::WIFI, state.wifi)
+          .set(GreeFrame::UNKNOWN_1, 0b0101) // Don't know why
+          .set(GreeFrame::UNKNOWN_2, 0b100)  // Don't know why
+          .set(GreeFrame::LIGHT, state.light)
+          .set(GreeFrame::IFEEL, state.ifeel);
+      if (state.timer > 0)
+      {
+        // Rounded up, so the unit never fires before the requested time
+        const uint16_t half_hours = (std::min(state.timer, GREE_TIMER_MAX) + 29) / 30;
+        const uint8_t hours = half_hours / 2;
+        frame.set(GreeFrame::TIMER_ENABLED, 1)
+            .set(GreeFrame::TIMER_HALF_HR, half_hours & 1)
+            .set(GreeFrame::TIMER_TENS_HR, hours / 10)
+            .set(GreeFrame::TIMER_HOURS, hours % 10);
+      }
+      frame.update_checksum();
+      return frame;
+    }
+
+    /// Extract the state carried by a frame. The checksum is not verified.
+    constexpr GreeState decode_state(GreeFrame frame)
+    {
+      GreeState state;
+      state.power = frame.get(GreeFrame::POWER) == GREE_POWER_ON;
+      state.mode = frame.get(GreeFrame::MODE);
+      state.fan = frame.get(GreeFrame::FAN);
+      state.temperature = frame.get(GreeFrame::TEMP) + GREE_TEMP_MIN;
+      state.swing_v = frame.get(GreeFrame::SWING_V);
+      state.swing_h = frame.get(GreeFrame::SWING_H);
+      state.swing_auto = frame.get(GreeFrame::SWING_AUTO);
+      state.sleep = frame.get(GreeFrame::SLEEP);
+      state.model_a = frame.get(GreeFrame::MODEL_A);
+      state.wifi = frame.get(GreeFrame::WIFI);
+      state.light = frame.get(GreeFrame::LIGHT);
+      state.ifeel = frame.get(GreeFrame::IFEEL);
+      if (frame.get(GreeFrame::TIMER_ENABLED))
+        state.timer = (frame.get(GreeFrame::TIMER_TENS_HR) * 10 + frame.get(GreeFrame::TIMER_HOURS)) * 60 +
+                      frame.get(GreeFrame::TIMER_HALF_HR) * 30;
+      return state;
+    }
+
+    constexpr uint16_t gree_timer_round_trip(uint16_t minutes)
+    {
+      GreeState state;
+      state.timer = minutes;
+      return decode_state(encode_state(state)).timer;
+    }
+    static_assert(gree_timer_round_trip(150) == 150, "timer round-trips in half hours");
+    static_assert(gree_timer_round_trip(61) == 90, "timer rounds up to the next half hour");
+    static_assert(gree_timer_round_trip(0) == 0, "timer off");
+
+    /// Destination for encoded pulses, in RawTimings form (marks positive, spaces negative).
+    class GreePulseSink
+    {
+    public:
+      virtual ~GreePulseSink() = default;
+      /// Called once before any write with the total number of timings that will follow.
+      virtual void reserve(size_t /* count */) {}
+      virtual void write(const int32_t *timings, size_t count) = 0;
+    };
+
+    /// True if `min <= value <= max`, in a single unsigned comparison.
+    constexpr bool in_window(int32_t value, int32_t min, int32_t max)
+    {
+      return static_cast<uint32_t>(value - min) <= static_cast<uint32_t>(max - min);
+    }
+
+    /// How far a timing may be from its nominal length: `percent` of the length plus `time`
+    /// microseconds either side. RemoteReceiveData's percentage and time modes each use one.
+    struct GreeTolerance
+    {
+      uint32_t percent{GREE_TOLERANCE};
+      uint32_t time{0};
+
+      constexpr int32_t lower(uint32_t length) const
+      {
+        const uint32_t scaled = this->percent < 100U ? length * (100U - this->percent) / 100U : 0;
+        return scaled > this->time ? scaled - this->time : 0;
+      }
+
+      constexpr int32_t upper(uint32_t length) const { return length * (100U + this->percent) / 100U + this->time; }
+
+      /// A tolerance at least as wide as both, for a prefilter that must pass either.
+      constexpr GreeTolerance merge(GreeTolerance other) const
+      {
+        return {std::max(this->percent, other.percent), std::max(this->time, other.time)};
+      }
+    };
+
+    /// True if `value` is within `tolerance` of `length`.
+    constexpr bool in_tolerance(int32_t value, uint32_t length, GreeTolerance tolerance = {})
+    {
+      return in_window(value, tolerance.lower(length), tolerance.upper(length));
+    }
+
+    /// Collects encoded pulses in a fixed buffer. Timings beyond its capacity are dropped.
+    template <size_t N>
+    class GreeArraySink : public GreePulseSink
+    {
+    public:
+      void write(const int32_t *timings, size_t count) override
+      {
+        count = std::min(count, N - this->size_);
+        memcpy(this->timings_.data() + this->size_, timings, count * sizeof(int32_t));
+        this->size_ += count;
+      }
+
+      const int32_t *data() const { return this->timings_.data(); }
+      size_t size() const { return this->size_; }
+
+    protected:
+      std::array<int32_t, N> timings_;
+      size_t size_{0};
+    };
+
+    // Largest receiver skew that is learned, in microseconds; about half the shortest space
+    const int32_t GREE_MAX_BIAS = 250;
+
+    /// How much longer marks and spaces measure than nominal, and how much they scatter
+    /// around that, in microseconds.
+    struct GreeCalibration
+    {
+      int16_t mark_bias{0};
+      int16_t space_bias{0};
+      /// Mean absolute deviation of timings from nominal once the bias is taken off; 0 until learned
+      uint16_t jitter{0};
+    };
+
+    // A learned window spans this many mean absolute deviations either side (about 4 sigma
+    // of Gaussian jitter), plus a share of the length for the remote's clock tolerance
+    const uint8_t GREE_JITTER_WINDOWS = 5;
+    const uint8_t GREE_CLOCK_TOLERANCE = 2;
+    // Learned windows are never narrower than this either side, in microseconds
+    const uint16_t GREE_MIN_WINDOW = 60;
+
+    /// Receive windows fitted to a learned calibration: they are narrower than the receiver's
+    /// percentage for the long header and message spaces, and follow the jitter for bits.
+    constexpr GreeTolerance gree_learned_tolerance(GreeCalibration calibration)
+    {
+      return {GREE_CLOCK_TOLERANCE, std::max<uint32_t>(GREE_MIN_WINDOW, calibration.jitter * GREE_JITTER_WINDOWS)};
+    }
+
+    /// Measure the mean offset of `captured` marks and spaces from the `nominal` timings they
+    /// were decoded as, and the mean absolute deviation around it. `bias` holds the current
+    /// calibration on entry, which is taken off each timing before it is checked, and the
+    /// measurements on return. Returns false if any corrected timing is not within tolerance,
+    /// so misaligned or noisy captures are not learned from.
+    inline bool gree_measure_bias(const int32_t *captured, const int32_t *nominal, size_t count, GreeCalibration &bias,
+                                  GreeTolerance tolerance = {})
+    {
+      const int32_t current[2] = {bias.space_bias, bias.mark_bias};
+      auto residual = [&](size_t i) {
+        const bool mark = nominal[i] > 0;
+        return (mark ? captured[i] - nominal[i] : nominal[i] - captured[i]) - current[mark];
+      };
+      int32_t sums[2]{};
+      int32_t counts[2]{};
+      for (size_t i = 0; i < count; i++)
+      {
+        const bool mark = nominal[i] > 0;
+        const uint32_t length = mark ? nominal[i] : -nominal[i];
+        if (!in_tolerance(static_cast<int32_t>(length) + residual(i), length, tolerance))
+          return false;
+        sums[mark] += residual(i);
+        counts[mark]++;
+      }
+      if (counts[0] == 0 || counts[1] == 0)
+        return false;
+      const int32_t means[2] = {sums[0] / counts[0], sums[1] / counts[1]};
+      uint32_t deviation = 0;
+      for (size_t i = 0; i < count; i++)
+      {
+        const int32_t offset = residual(i) - means[nominal[i] > 0];
+        deviation += offset < 0 ? -offset : offset;
+      }
+      bias.mark_bias = current[1] + means[1];
+      bias.space_bias = current[0] + means[0];
+      bias.jitter = deviation / count;
+      return true;
+    }
+
+    /// Read cursor over captured pulses in RawTimings form, with the same
+    /// tolerance semantics as ESPHome's RemoteReceiveData.
+    /// A calibration, if set, is taken off every timing as it is read.
+    class GreePulseSource
+    {
+    public:
+      GreePulseSource(const int32_t *data, size_t size, GreeTolerance tolerance = {})
+          : data_(data), size_(size), tolerance_(tolerance) {}
+
+      void set_calibration(GreeCalibration calibration)
+      {
+        this->mark_bias_ = calibration.mark_bias;
+        this->space_bias_ = calibration.space_bias;
+      }
+
+      size_t size() const { return this->size_; }
+      GreeTolerance get_tolerance() const { return this->tolerance_; }
+      GreeCalibration get_calibration() const
+      {
+        GreeCalibration calibration;
+        calibration.mark_bias = this->mark_bias_;
+        calibration.space_bias = this->space_bias_;
+        return calibration;
+      }
+      size_t get_index() const { return this->index_; }
+      bool is_valid(size_t offset = 0) const { return this->index_ + offset < this->size_; }
+      int32_t peek(size_t offset = 0) const
+      {
+        const int32_t value = this->data_[this->index_ + offset];
+        return value >= 0 ? value - this->mark_bias_ : value + this->space_bias_;
+      }
+      /// Timings from the read cursor on, and how many there are.
+      const int32_t *get_pointer() const { return this->data_ + this->index_; }
+      size_t remaining() const { return this->size_ - this->index_; }
+
+      bool peek_mark(uint32_t length, size_t offset = 0) const
+      {
+        if (!this->is_valid(offset))
+          return false;
+        const int32_t value = this->peek(offset);
+        return value >= 0 && in_tolerance(value, length, this->tolerance_);
+      }
+
+      bool peek_space(uint32_t length, size_t offset = 0) const
+      {
+        if (!this->is_valid(offset))
+          return false;
+        const int32_t value = this->peek(offset);
+        return value <= 0 && in_tolerance(-value, length, this->tolerance_);
+      }
+
+      bool expect_item(uint32_t mark, uint32_t space)
+      {
+        if (!this->peek_mark(mark) || !this->peek_space(space, 1))
+          return false;
+        this->advance(2);
+        return true;
+      }
+
+      void advance(size_t amount = 1) { this->index_ += amount; }
+      void reset() { this->index_ = 0; }
+
+    protected:
+      const int32_t *data_;
+      size_t size_;
+      size_t index_{0};
+      GreeTolerance tolerance_;
+      int32_t mark_bias_{0};
+      int32_t space_bias_{0};
+    };
+
+    /// Mark/space timings of every 4-bit value, LSB first, in RawTimings form (spaces negative).
+    /// Encoding a byte is two copies out of this table instead of a loop over its bits.
+    template <typename Timing>
+    struct GreePulseTable
+    {
+      using Nibble = std::array<int32_t, 8>;
+
+      static constexpr std::array<Nibble, 16> build()
+      {
+        std::array<Nibble, 16> table{};
+        for (uint8_t value = 0; value < 16; value++)
+        {
+          for (uint8_t bit = 0; bit < 4; bit++)
+          {
+            table[value][bit * 2] = Timing::BIT_MARK;
+            table[value][bit * 2 + 1] = -static_cast<int32_t>((value & (1 << bit)) ? Timing::ONE_SPACE : Timing::ZERO_SPACE);
+          }
+        }
+        return table;
+      }
+
+      static constexpr std::array<Nibble, 16> NIBBLES = build();
+    };
+
+    /// Copy the pulses of the low `length` bits of `value` (at most 4) to `out`. Returns the new end.
+    template <typename Timing>
+    int32_t *put_nibble(int32_t *out, uint8_t value, uint8_t length = 4)
+    {
+      memcpy(out, GreePulseTable<Timing>::NIBBLES[value & 0x0F].data(), length * 2 * sizeof(int32_t));
+      return out + length * 2;
+    }
+
+    /// Copy the pulses of `count` bytes to `out`. Returns the new end.
+    template <typename Timing>
+    int32_t *put_bytes(int32_t *out, const uint8_t *bytes, size_t count)
+    {
+      for (size_t i = 0; i < count; i++)
+      {
+        out = put_nibble<Timing>(out, bytes[i]);
+        out = put_nibble<Timing>(out, bytes[i] >> 4);
+      }
+      return out;
+    }
+
+    /// Receive windows of a timing set. Any bit mark within tolerance is accepted, and a
+    /// space anywhere between the shortest zero and the longest one is classified by
+    /// which side of the midpoint it falls on. Built once per capture from the receiver's
+    /// tolerance, so each symbol still costs one comparison.
+    template <typename Timing>
+    struct GreeBitWindows
+    {
+      explicit constexpr GreeBitWindows(GreeTolerance tolerance = {})
+          : mark_min(tolerance.lower(Timing::BIT_MARK)), mark_max(tolerance.upper(Timing::BIT_MARK)),
+            space_min(tolerance.lower(Timing::ZERO_SPACE)), space_max(tolerance.upper(Timing::ONE_SPACE)) {}
+
+      constexpr bool is_mark(int32_t mark) const { return in_window(mark, this->mark_min, this->mark_max); }
+      constexpr bool is_space(int32_t space) const { return in_window(space, this->space_min, this->space_max); }
+
+      int32_t mark_min;
+      int32_t mark_max;
+      int32_t space_min;
+      int32_t space_max;
+      int32_t space_threshold{(Timing::ZERO_SPACE + Timing::ONE_SPACE) / 2};
+    };
+
+    /// Read `length` LSB-first bits. Stops at the first invalid symbol, leaving the
+    /// source index on it.
+    template <typename Timing>
+    bool get_bits(GreePulseSource &source, uint8_t &byte, uint8_t length, const GreeBitWindows<Timing> &windows)
+    {
+      byte = 0;
+      if (!source.is_valid(length * 2 - 1))
+        return false;
+      for (uint8_t j = 0; j < length; j++)
+      {
+        const int32_t mark = source.peek();
+        const int32_t space = -source.peek(1);
+        if (!windows.is_mark(mark) || !windows.is_space(space))
+          return false;
+        if (space > windows.space_threshold)
+          byte |= (1 << j);
+        source.advance(2);
+      }
+      return true;
+    }
+
+    /// Read `count` bytes. Bytes before a failure are stored, the rest are left as they were.
+    template <typename Timing>
+    bool get_bytes(GreePulseSource &source, uint8_t *bytes, size_t count, const GreeBitWindows<Timing> &windows)
+    {
+      for (size_t i = 0; i < count; i++)
+      {
+        uint8_t byte;
+        if (!get_bits<Timing>(source, byte, 8, windows))
+          return false;
+        bytes[i] = byte;
+      }
+      return true;
+    }
+
+    /// Where decoding a frame stopped.
+    enum class GreeDecodeStage : uint8_t
+    {
+      OK,
+      HEADER,
+      BLOCK_1,
+      FOOTER,
+      MESSAGE_SPACE,
+      BLOCK_2,
+    };
+
+    inline const char *gree_decode_stage_to_string(GreeDecodeStage stage)
+    {
+      switch (stage)
+      {
+      case GreeDecodeStage::OK:
+        return "OK";
+      case GreeDecodeStage::HEADER:
+        return "Header";
+      case GreeDecodeStage::BLOCK_1:
+        return "Block 1";
+      case GreeDecodeStage::FOOTER:
+        return "Block footer";
+      case GreeDecodeStage::MESSAGE_SPACE:
+        return "Message space";
+      case GreeDecodeStage::BLOCK_2:
+        return "Block 2";
+      default:
+        return "Unknown";
+      }
+    }
+
+    /// Shape of a frame in the Kelvinator pulse-distance family, which Gree belongs to. The state
+    /// is sent in sections of 8 bytes, each a header, a 4-byte block, a `FooterSize`-bit footer,
+    /// a message space, a second 4-byte block and `SectionSpace`. Bits are sent LSB first.
+    template <typename TimingT, size_t Bytes, uint32_t SectionSpace = TimingT::MESSAGE_SPACE,
+              uint8_t Footer = 0b010, uint8_t FooterSize = GREE_BLOCK_FOOTER_SIZE>
+    struct GreePulseDistanceLayout
+    {
+      static_assert(Bytes % 8 == 0, "frames are made of 8-byte sections");
+
+      using Timing = TimingT;
+      static constexpr size_t BYTES = Bytes;
+      static constexpr size_t SECTIONS = Bytes / 8;
+      static constexpr uint32_t SECTION_SPACE = SectionSpace;
+      static constexpr uint8_t FOOTER = Footer;
+      static constexpr uint8_t FOOTER_SIZE = FooterSize;
+      static constexpr size_t SECTION_ITEMS = 2 + 64 + FooterSize * 2 + 2 + 64 + 2;
+      static constexpr size_t ITEMS = SECTIONS * SECTION_ITEMS;
+    };
+
+    /// Checksum policy of the family: the high nibble of the last byte of every 8-byte section.
+    struct GreeSectionChecksum
+    {
+      static bool is_valid(const uint8_t *bytes, size_t size)
+      {
+        for (size_t offset = 0; offset < size; offset += 8)
+        {
+          if (!section_(bytes + offset).is_checksum_valid())
+            return false;
+        }
+        return true;
+      }
+
+      static void update(uint8_t *bytes, size_t size)
+      {
+        for (size_t offset = 0; offset < size; offset += 8)
+          bytes[offset + 7] = section_(bytes + offset).update_checksum().get_byte(7);
+      }
+
+    protected:
+      static GreeFrame section_(const uint8_t *bytes)
+      {
+        GreeFrame frame;
+        for (uint8_t i = 0; i < 8; i++)
+          frame.set_byte(i, bytes[i]);
+        return frame;
+      }
+    };
+
+    /// Pulse-distance encoder and decoder for any `GreePulseDistanceLayout`. GreeCodec is its
+    /// 8-byte instantiation; 16-byte Kelvinator units and other variants only need a layout.
+    template <typename Layout, typename Checksum = GreeSectionChecksum>
+    struct GreePulseDistanceCodec
+    {
+      using Timing = typename Layout::Timing;
+      using Timings = std::array<int32_t, Layout::ITEMS>;
+
+      /// Encode `Layout::BYTES` bytes into `out`. Returns the new end.
+      static int32_t *encode(const uint8_t *bytes, int32_t *out)
+      {
+        for (size_t section = 0; section < Layout::SECTIONS; section++, bytes += 8)
+        {
+          *out++ = Timing::HEADER_MARK;
+          *out++ = -static_cast<int32_t>(Timing::HEADER_SPACE);
+          out = put_bytes<Timing>(out, bytes, 4);                          // block 1
+          out = put_nibble<Timing>(out, Layout::FOOTER, Layout::FOOTER_SIZE); // block footer
+          *out++ = Timing::BIT_MARK;                                       // message space
+          *out++ = -static_cast<int32_t>(Timing::MESSAGE_SPACE);
+          out = put_bytes<Timing>(out, bytes + 4, 4); // block 2
+          *out++ = Timing::BIT_MARK;                  // section space
+          *out++ = -static_cast<int32_t>(Layout::SECTION_SPACE);
+        }
+        return out;
+      }
+
+      /// Decode `Layout::BYTES` bytes from `source`. Bytes are stored as they are read, so the
+      /// blocks before a failure are valid.
+      static GreeDecodeStage decode(GreePulseSource &source, uint8_t *bytes)
+      {
+        return decode(source, bytes, GreeBitWindows<Timing>(source.get_tolerance()));
+      }
+
+      /// As above, with bit windows already built for the source's tolerance.
+      static GreeDecodeStage decode(GreePulseSource &source, uint8_t *bytes, const GreeBitWindows<Timing> &windows)
+      {
+        for (size_t section = 0; section < Layout::SECTIONS; section++, bytes += 8)
+        {
+          if (section > 0 && !source.expect_item(Timing::BIT_MARK, Layout::SECTION_SPACE))
+            return GreeDecodeStage::HEADER;
+          if (!source.expect_item(Timing::HEADER_MARK, Timing::HEADER_SPACE))
+            return GreeDecodeStage::HEADER;
+          if (!get_bytes<Timing>(source, bytes, 4, windows))
+            return GreeDecodeStage::BLOCK_1;
+          uint8_t footer = 0;
+          if (!get_bits<Timing>(source, footer, Layout::FOOTER_SIZE, windows) || footer != Layout::FOOTER)
+            return GreeDecodeStage::FOOTER;
+          if (!source.expect_item(Timing::BIT_MARK, Timing::MESSAGE_SPACE))
+            return GreeDecodeStage::MESSAGE_SPACE;
+          if (!get_bytes<Timing>(source, bytes + 4, 4, windows))
+            return GreeDecodeStage::BLOCK_2;
+        }
+        return GreeDecodeStage::OK;
+      }
+
+      static bool is_checksum_valid(const uint8_t *bytes) { return Checksum::is_valid(bytes, Layout::BYTES); }
+      static void update_checksum(uint8_t *bytes) { Checksum::update(bytes, Layout::BYTES); }
+    };
+
+    /// Ring of the most recent raw captures and how decoding them went, for reproducing
+    /// field failures. Each timing is stored as the zigzag varint of its difference from the
+    /// previous timing of the same kind, so the steady marks take one byte and the alternating
+    /// spaces two: about a third of the RawTimings size.
+    class GreeCaptureRecorder
+    {
+    public:
+      struct Capture
+      {
+        uint32_t time{0};
+        /// False if the capture was rejected before decoding.
+        bool matched{false};
+        GreeDecodeStage stage{GreeDecodeStage::HEADER};
+        /// Sign of the first timing; the rest alternate.
+        bool starts_with_mark{true};
+        std::vector<uint8_t> bytes;
+      };
+
+      explicit GreeCaptureRecorder(size_t capacity) : captures_(capacity) {}
+
+      void record(uint32_t time, const int32_t *data, size_t size, bool matched, GreeDecodeStage stage)
+      {
+        if (this->captures_.empty())
+          return;
+        Capture &capture = this->captures_[this->next_];
+        this->next_ = (this->next_ + 1) % this->captures_.size();
+        this->count_ = std::min(this->count_ + 1, this->captures_.size());
+
+        capture.time = time;
+        capture.matched = matched;
+        capture.stage = stage;
+        capture.starts_with_mark = size == 0 || data[0] >= 0;
+        capture.bytes.clear();
+        int32_t previous[2]{};
+        for (size_t i = 0; i < size; i++)
+        {
+          const int32_t duration = data[i] < 0 ? -data[i] : data[i];
+          const int32_t delta = duration - previous[i & 1];
+          previous[i & 1] = duration;
+          uint32_t zigzag = (static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31);
+          for (; zigzag >= 0x80; zigzag >>= 7)
+            capture.bytes.push_back(static_cast<uint8_t>(zigzag | 0x80));
+          capture.bytes.push_back(static_cast<uint8_t>(zigzag));
+        }
+      }
+
+      /// Number of captures held.
+      size_t size() const { return this->count_; }
+
+      /// The `index`th capture held, oldest first.
+      const Capture &get(size_t index) const
+      {
+        const size_t oldest = (this->next_ + this->captures_.size() - this->count_) % this->captures_.size();
+        return this->captures_[(oldest + index) % this->captures_.size()];
+      }
+
+      /// Restore the RawTimings of a capture.
+      static void expand(const Capture &capture, std::vector<int32_t> &out)
+      {
+        out.clear();
+        int32_t previous[2]{};
+        uint32_t zigzag = 0;
+        uint8_t shift = 0;
+        for (uint8_t byte : capture.bytes)
+        {
+          zigzag |= static_cast<uint32_t>(byte & 0x7F) << shift;
+          shift += 7;
+          if (byte & 0x80)
+            continue;
+          const size_t i = out.size();
+          const int32_t duration = previous[i & 1] + static_cast<int32_t>((zigzag >> 1) ^ -(zigzag & 1));
+          previous[i & 1] = duration;
+          out.push_back(((i & 1) == 0) == capture.starts_with_mark ? duration : -duration);
+          zigzag = 0;
+          shift = 0;
+        }
+      }
+
+    protected:
+      std::vector<Capture> captures_;
+      size_t next_{0};
+      size_t count_{0};
+    };
+
+    /// Per-bit majority vote over the blocks of repeated frames.
+    class GreeFrameVote
+    {
+    public:
+      /// Count the 32-bit block of `frame` starting at byte `offset` (0 or 4) as one vote.
+      void add_block(GreeFrame frame, uint8_t offset)
+      {
+        const uint8_t block = offset / 4;
+        if (this->votes_[block]++ == 0)
+        {
+          for (uint8_t i = offset; i < offset + 4; i++)
+            this->first_.set_byte(i, frame.get_byte(i));
+        }
+        for (uint8_t bit = offset * 8; bit < (offset + 4) * 8; bit++)
+          this->ones_[bit] += (frame.raw() >> bit) & 1;
+      }
+
+      /// True once both blocks have at least one vote.
+      bool is_complete() const { return this->votes_[0] > 0 && this->votes_[1] > 0; }
+
+      /// The majority value of every bit. Ties go to the first frame that voted.
+      GreeFrame get_result() const
+      {
+        uint64_t raw = 0;
+        for (uint8_t bit = 0; bit < 64; bit++)
+        {
+          const uint8_t votes = this->votes_[bit / 32];
+          const uint8_t ones = this->ones_[bit] * 2;
+          const bool value = ones == votes ? (this->first_.raw() >> bit) & 1 : ones > votes;
+          raw |= static_cast<uint64_t>(value) << bit;
+        }
+        return GreeFrame(raw);
+      }
+
+    protected:
+      uint8_t votes_[2]{};
+      uint8_t ones_[64]{};
+      GreeFrame first_;
+    };
+
+    /// The timings a frame's shape is judged by, corrected for a calibration: the header, the
+    /// first bit and the message space between the blocks.
+    struct GreeFrameShape
+    {
+      int32_t header_mark;
+      int32_t header_space;
+      int32_t bit_mark;
+      int32_t bit_space;
+      int32_t message_mark;
+      int32_t message_space;
+
+      static GreeFrameShape at(const int32_t *frame, GreeCalibration calibration)
+      {
+        return {frame[0] - calibration.mark_bias,
+                -frame[1] - calibration.space_bias,
+                frame[2] - calibration.mark_bias,
+                -frame[3] - calibration.space_bias,
+                frame[GREE_MESSAGE_SPACE_INDEX] - calibration.mark_bias,
+                -frame[GREE_MESSAGE_SPACE_INDEX + 1] - calibration.space_bias};
+      }
+    };
+
+    /// Last offset a frame is looked for at in a capture of `size` timings: every offset within
+    /// the first frame, as long as a whole frame still fits after it.
+    constexpr size_t gree_last_frame_offset(size_t size)
+    {
+      return size > GREE_FRAME_ITEMS ? std::min(GREE_FRAME_ITEMS, size - GREE_MIN_CAPTURE_ITEMS) : 0;
+    }
+
+    /// Pulse codec of one model variant.
+    template <GreeIRModel Model>
+    struct GreeCodec
+    {
+      using Timing = GreeTiming<Model>;
+
+      using Layout = GreePulseDistanceLayout<Timing, 8>;
+      using Engine = GreePulseDistanceCodec<Layout>;
+      static_assert(Layout::ITEMS == GREE_FRAME_ITEMS, "a Gree frame is one 8-byte section");
+
+      /// Encode one complete frame (header, both blocks and message spaces).
+      static void encode_frame(GreeFrame state, GreeFrameTimings &frame)
+      {
+        uint8_t bytes[8];
+        for (uint8_t i = 0; i < 8; i++)
+          bytes[i] = state.get_byte(i);
+        Engine::encode(bytes, frame.data());
+      }
+
+      /// Encode the frame once and write it `repeat` times to `sink`.
+      static void encode(GreeFrame state, GreePulseSink &sink, uint8_t repeat)
+      {
+        GreeFrameTimings frame;
+        encode_frame(state, frame);
+        sink.reserve(repeat * frame.size());
+        for (uint8_t i = 0; i < repeat; i++)
+          sink.write(frame.data(), frame.size());
+      }
+
+      /// Encode an iFeel report of the room temperature (°C). It is a short standalone
+      /// message, so the cached state frame is neither rebuilt nor resent.
+      static void encode_ifeel(uint8_t temperature, GreePulseSink &sink)
+      {
+        std::array<int32_t, GREE_IFEEL_ITEMS> report;
+        int32_t *out = report.data();
+        *out++ = GREE_IFEEL_HEADER_MARK;
+        *out++ = -static_cast<int32_t>(GREE_IFEEL_HEADER_SPACE);
+        out = put_nibble<Timing>(out, temperature);
+        out = put_nibble<Timing>(out, temperature >> 4);
+        out = put_nibble<Timing>(out, GREE_IFEEL_SIGNATURE);
+        out = put_nibble<Timing>(out, GREE_IFEEL_SIGNATURE >> 4);
+        *out++ = Timing::BIT_MARK;
+        *out++ = -static_cast<int32_t>(Timing::MESSAGE_SPACE);
+        sink.reserve(report.size());
+        sink.write(report.data(), report.size());
+      }
+
+      /// Bounded check that a capture has this model's shape: its length, the header,
+      /// the first bit and the message space between the blocks. Meant to run before
+      /// any other work, so captures from other remotes are dropped cheaply.
+      static bool matches(const int32_t *data, size_t size, GreeTolerance tolerance = {},
+                          GreeCalibration calibration = {})
+      {
+        return find_frame(data, size, tolerance, calibration) < size;
+      }
+
+      /// Offset of the first frame with this model's shape, or `size` if there is none. A
+      /// capture longer than one frame may start with a damaged repeat that decode_repeated()
+      /// can still outvote, so the shape is looked for at every offset within its first frame.
+      /// Timings are corrected by `calibration` as the decoder would.
+      static size_t find_frame(const int32_t *data, size_t size, GreeTolerance tolerance = {},
+                               GreeCalibration calibration = {})
+      {
+        if (size < GREE_MIN_CAPTURE_ITEMS)
+          return size;
+        const size_t last = gree_last_frame_offset(size);
+        const GreeBitWindows<Timing> windows(tolerance);
+        for (size_t offset = 0; offset <= last; offset++)
+        {
+          if (has_shape(GreeFrameShape::at(data + offset, calibration), tolerance, windows))
+            return offset;
+        }
+        return size;
+      }
+
+      /// Whether `shape` fits this model, with `windows` built for `tolerance`.
+      static bool has_shape(const GreeFrameShape &shape, GreeTolerance tolerance, const GreeBitWindows<Timing> &windows)
+      {
+        return in_tolerance(shape.header_mark, Timing::HEADER_MARK, tolerance) &&
+               in_tolerance(shape.header_space, Timing::HEADER_SPACE, tolerance) && windows.is_mark(shape.bit_mark) &&
+               windows.is_space(shape.bit_space) && windows.is_mark(shape.message_mark) &&
+               in_tolerance(shape.message_space, Timing::MESSAGE_SPACE, tolerance);
+      }
+
+      /// Decode one frame from `source` into `frame`.
+      static GreeDecodeStage decode(GreePulseSource &source, GreeFrame &frame)
+      {
+        return decode(source, frame, GreeBitWindows<Timing>(source.get_tolerance()));
+      }
+
+      /// As above, with bit windows already built for the source's tolerance.
+      static GreeDecodeStage decode(GreePulseSource &source, GreeFrame &frame, const GreeBitWindows<Timing> &windows)
+      {
+        uint8_t bytes[8];
+        for (uint8_t i = 0; i < 8; i++)
+          bytes[i] = frame.get_byte(i);
+        const GreeDecodeStage stage = Engine::decode(source, bytes, windows);
+        for (uint8_t i = 0; i < 8; i++)
+          frame.set_byte(i, bytes[i]);
+        return stage;
+      }
+
+      /// Move `source` to the next header. Returns false if there is none.
+      static bool seek_header(GreePulseSource &source)
+      {
+        for (; source.is_valid(1); source.advance())
+        {
+          if (source.peek_mark(Timing::HEADER_MARK) && source.peek_space(Timing::HEADER_SPACE, 1))
+            return true;
+        }
+        return false;
+      }
+
+      /// Decode a capture holding one or more repeats of a frame. Every frame is decoded,
+      /// including the intact block of a damaged one, and the blocks are combined by a per-bit
+      /// majority vote. If the voted frame fails its checksum, the first frame that passes
+      /// it on its own is used instead. Returns the first frame's failing stage if no complete
+      /// frame could be assembled.
+      static GreeDecodeStage decode_repeated(GreePulseSource &source, GreeFrame &result)
+      {
+        const GreeBitWindows<Timing> windows(source.get_tolerance());
+        GreeFrameVote vote;
+        GreeFrame checked;
+        bool has_checked = false;
+        GreeDecodeStage first_stage = GreeDecodeStage::HEADER;
+
+        for (uint8_t frames = 0; frames < GREE_MAX_CAPTURE_FRAMES && seek_header(source); frames++)
+        {
+          GreeFrame frame;
+          const GreeDecodeStage stage = decode(source, frame, windows);
+          if (frames == 0)
+            first_stage = stage;
+          if (stage == GreeDecodeStage::OK || stage >= GreeDecodeStage::FOOTER)
+            vote.add_block(frame, 0);
+          if (stage != GreeDecodeStage::OK)
+            continue;
+          vote.add_block(frame, 4);
+          if (!has_checked && frame.is_checksum_valid())
+          {
+            checked = frame;
+            has_checked = true;
+          }
+        }
+
+        if (!vote.is_complete())
+          return first_stage == GreeDecodeStage::OK ? GreeDecodeStage::BLOCK_2 : first_stage;
+
+        result = vote.get_result();
+        if (has_checked && !result.is_checksum_valid())
+          result = checked;
+        return GreeDecodeStage::OK;
+      }
+    };
+
+    /// Kelvinator units send 16 bytes in two sections, separated by a double message space.
+    using GreeKelvinatorCodec =
+        GreePulseDistanceCodec<GreePulseDistanceLayout<GreeKelvinatorTiming, 16, 2 * GreeKelvinatorTiming::MESSAGE_SPACE>>;
+
+    /// Call `f` with a default-constructed GreeCodec of a model known only at runtime.
+    template <typename F>
+    auto gree_with_codec(GreeIRModel model, F &&f) -> decltype(f(GreeCodec<GreeIRModel::GENERIC>{}))
+    {
+      switch (model)
+      {
+      case GreeIRModel::YAW1F:
+        return f(GreeCodec<GreeIRModel::YAW1F>{});
+      case GreeIRModel::YBOFB:
+        return f(GreeCodec<GreeIRModel::YBOFB>{});
+      case GreeIRModel::YAC1FB9:
+        return f(GreeCodec<GreeIRModel::YAC1FB9>{});
+      case GreeIRModel::YT1F:
+        return f(GreeCodec<GreeIRModel::YT1F>{});
+      default:
+        return f(GreeCodec<GreeIRModel::GENERIC>{});
+      }
+    }
+
+    /// Distance of `value` from `nominal`, in per-mille of `nominal`.
+    constexpr uint32_t timing_error(int32_t value, uint32_t nominal)
+    {
+      return (value > static_cast<int32_t>(nominal) ? value - nominal : nominal - value) * 1000U / nominal;
+    }
+
+    /// Classify a capture against the timings of every known variant in one pass. At the first
+    /// offset where any variant finds a frame, the variant among those accepting it with the
+    /// smallest summed header and message-space error wins. Variants sharing timings are reported as
+    /// GENERIC (also YT1F) and YAW1F (also YBOFB, told apart by the frame's ModelA bit).
+    inline bool gree_classify(const int32_t *data, size_t size, GreeIRModel &model, GreeTolerance tolerance = {},
+                              GreeCalibration calibration = {})
+    {
+      using Generic = GreeCodec<GreeIRModel::GENERIC>;
+      using Yac = GreeCodec<GreeIRModel::YAC1FB9>;
+      using Yaw = GreeCodec<GreeIRModel::YAW1F>;
+      if (size < GREE_MIN_CAPTURE_ITEMS)
+        return false;
+      const GreeBitWindows<Generic::Timing> generic_windows(tolerance);
+      const GreeBitWindows<Yac::Timing> yac_windows(tolerance);
+      const GreeBitWindows<Yaw::Timing> yaw_windows(tolerance);
+
+      const size_t last = gree_last_frame_offset(size);
+      for (size_t offset = 0; offset <= last; offset++)
+      {
+        const GreeFrameShape shape = GreeFrameShape::at(data + offset, calibration);
+        uint32_t best = UINT32_MAX;
+        auto consider = [&](auto codec, const auto &windows, GreeIRModel candidate) {
+          using Timing = typename decltype(codec)::Timing;
+          if (!decltype(codec)::has_shape(shape, tolerance, windows))
+            return;
+          const uint32_t score = timing_error(shape.header_mark, Timing::HEADER_MARK) +
+                                 timing_error(shape.header_space, Timing::HEADER_SPACE) +
+                                 timing_error(shape.message_space, Timing::MESSAGE_SPACE);
+          if (score < best)
+          {
+            best = score;
+            model = candidate;
+          }
+        };
+        consider(Generic{}, generic_windows, GreeIRModel::GENERIC);
+        consider(Yac{}, yac_windows, GreeIRModel::YAC1FB9);
+        consider(Yaw{}, yaw_windows, GreeIRModel::YAW1F);
+        if (best != UINT32_MAX)
+          return true;
+      }
+      return false;
+    }
+
+  } // namespace greeir
+} // namespace esphome
@@ -1,14 +1,122 @@
 #include "greeir.h"
 #include "esphome/core/log.h"
 
+#include <algorithm>
+#include <cinttypes>
+
+#if defined(USE_GREEIR_FAST_BOOT) && defined(USE_ESP32)
+#include <esp_attr.h>
+#endif
+
 namespace esphome
 {
   namespace greeir
   {
 
     static const char *const TAG = "greeir.climate";
+    // Mixed into the object id hash so the detected model doesn't collide with the climate restore state
+    static const uint32_t DETECTED_MODEL_PREF_HASH = 0x47524545;
+    // Slack after a burst's airtime for the receiver's idle timeout and loop latency
+    static const uint32_t ECHO_MARGIN_MS = 250;
+    static const uint32_t CALIBRATION_PREF_HASH = 0x43414C42;
+    // Each frame moves the calibration 1/CALIBRATION_WEIGHT of the way to its own measurement
+    static const int32_t CALIBRATION_WEIGHT = 8;
+    // Smallest change in microseconds that is written to flash
+    static const int32_t CALIBRATION_SAVE_STEP = 5;
+    static const uint32_t LAST_SENT_PREF_HASH = 0x46524D45;
+    // Quiet period after the last state change before the frame is written to flash
+    static const uint32_t LAST_SENT_SAVE_DELAY_MS = 10000;
+
+    /// `frame` with its timer fields cleared.
+    static GreeFrame without_timer(GreeFrame frame)
+    {
+      return frame.set(GreeFrame::TIMER_ENABLED, 0)
+          .set(GreeFrame::TIMER_HALF_HR, 0)
+          .set(GreeFrame::TIMER_TENS_HR, 0)
+          .set(GreeFrame::TIMER_HOURS, 0);
+    }
 
-    void GreeIRClimate::control(const climate::ClimateCall &call)
+#ifdef USE_GREEIR_FAST_BOOT
+    static const uint32_t WAKE_FRAME_PREF_HASH = 0x57414B45;
+
+    /// Frame waiting to be sent on the next boot. `key` ties it to an entity; 0 means none.
+    struct GreeWakeFrame
+    {
+      uint32_t key;
+      uint64_t frame;
+    };
+
+#ifdef USE_ESP32
+    // RTC slow memory keeps its contents through deep sleep and is not worn like flash.
+    // Each entity with a stored frame takes the slot holding its key.
+    static const size_t WAKE_FRAME_SLOTS = 4;
+    static RTC_DATA_ATTR GreeWakeFrame wake_frames_rtc[WAKE_FRAME_SLOTS];
+
+    bool GreeIRClimate::load_wake_frame_(uint32_t key, uint64_t &frame)
+    {
+      for (const GreeWakeFrame &slot : wake_frames_rtc)
+      {
+        if (slot.key == key)
+        {
+          frame = slot.frame;
+          return true;
+        }
+      }
+      return false;
+    }
+
+    void GreeIRClimate::save_wake_frame_(uint32_t key, uint64_t frame)
+    {
+      GreeWakeFrame *free_slot = nullptr;
+      for (GreeWakeFrame &slot : wake_frames_rtc)
+      {
+        if (slot.key == key)
+        {
+          slot.frame = frame;
+          return;
+        }
+        if (free_slot == nullptr && slot.key == 0)
+          free_slot = &slot;
+      }
+      if (free_slot == nullptr)
+      {
+        ESP_LOGW(TAG, "No RTC slot left for the wake frame, at most %zu entities can use fast_boot", WAKE_FRAME_SLOTS);
+        return;
+      }
+      *free_slot = GreeWakeFrame{key, frame};
+    }
+
+    void GreeIRClimate::clear_wake_frame_(uint32_t key)
+    {
+      for (GreeWakeFrame &slot : wake_frames_rtc)
+      {
+        if (slot.key == key)
+          slot = GreeWakeFrame{0, 0};
+      }
+    }
+#else
+    // Other platforms keep it as a preference outside flash, which is RTC memory on the ESP8266
+    bool GreeIRClimate::load_wake_frame_(uint32_t key, uint64_t &frame)
+    {
+      GreeWakeFrame wake;
+      if (!this->wake_pref_.load(&wake) || wake.key != key)
+        return false;
+      frame = wake.frame;
+      return true;
+    }
+
+    void GreeIRClimate::save_wake_frame_(uint32_t key, uint64_t frame)
+    {
+      const GreeWakeFrame wake{key, frame};
+      this->wake_pref_.save(&wake);
+    }
+
+    // The preference belongs to this entity alone, so it is simply emptied
+    void GreeIRClimate::clear_wake_frame_(uint32_t /*key*/) { this->save_wake_frame_(0, 0); }
+#endif
+#endif
+
+    void GreeIRClimate::apply_call_(const climate::ClimateCall &call)
     {
       if (call.get_mode().has_value())
         this->mode = *call.get_mode();
@@ -20,362 +128,613 @@ namespace esphome
         this->swing_mode = *call.get_swing_mode();
       if (call.get_preset().has_value())
         this->preset = *call.get_preset();
-
-      this->transmit_state();
-      this->publish_state();
     }
 
-    const uint8_t kKelvinatorChecksumStart = 10;
+    void GreeIRClimate::control(const climate::ClimateCall &call)
+    {
+      const bool was_on = this->mode != climate::CLIMATE_MODE_OFF;
+      this->apply_call_(call);
+      if (this->mode != climate::CLIMATE_MODE_OFF)
+        this->resume_mode_ = this->mode;
+      // A timer set to toggle power would toggle it back, so switching by hand cancels it
+      if ((this->mode != climate::CLIMATE_MODE_OFF) != was_on && this->timer_running_)
+      {
+        ESP_LOGD(TAG, "Power switched, cancelling onboard timer");
+        this->track_timer_(0);
+      }
 
-    /// Calculate the checksum for a given block of state.
-    /// @param[in] block A pointer to a block to calc the checksum of.
-    /// @param[in] length Length of the block array to checksum.
-    /// @return The calculated checksum value.
-    /// @note Many Bothans died to bring us this information.
-    static uint8_t calcBlockChecksum(const uint8_t *block, const uint16_t length)
+      if (this->coalesce_window_ == 0)
+      {
+        this->transmit_state();
+        this->publish_state();
+        return;
+      }
+
+      // Merge every call arriving within the window into a single frame
+      if (this->transmit_pending_)
+        return;
+      this->transmit_pending_ = true;
+      this->set_timeout("coalesce", this->coalesce_window_, [this]() {
+        this->transmit_pending_ = false;
+        this->transmit_state();
+        this->publish_state();
+      });
+    }
+
+    GreeFrame GreeIRClimate::get_state_to_send()
     {
-      uint8_t sum = kKelvinatorChecksumStart;
-      // Sum the lower half of the first 4 bytes of this block.
-      for (uint8_t i = 0; i < 4 && i < length - 1; i++, block++)
-        sum += (*block & 0b1111);
-      // then sum the upper half of the next 3 bytes.
-      for (uint8_t i = 4; i < length - 1; i++, block++)
-        sum += (*block >> 4);
-      // Trim it down to fit into the 4 bits allowed. i.e. Mod 16.
-      return sum & 0b1111;
+      GreeState state;
+      state.power = this->mode != climate::CLIMATE_MODE_OFF;
+      state.mode = this->operation_mode_();
+      // The timer fields only mean what they were set to mean under the same power state
+      state.timer = state.power == this->timer_power_ ? this->get_timer_remaining() : 0;
+      // An on timer powers the unit on in the mode carried by the frame
+      if (!state.power && state.timer > 0)
+        state.mode = gree_encode(GREE_MODE_MAP, this->resume_mode_, GREE_MODE_AUTO);
+      state.fan = this->fan_speed_();
+      state.temperature = this->target_temperature;
+      state.swing_auto = this->swing_auto_();
+      state.swing_v = this->vertical_swing_();
+      state.swing_h = this->horizontal_swing_();
+      state.sleep = this->preset == climate::CLIMATE_PRESET_SLEEP;
+      state.model_a = this->get_model() == GreeIRModel::YAW1F || this->get_model() == GreeIRModel::YAC1FB9;
+      state.wifi = this->wifi_function_;
+      state.light = true;
+      state.ifeel = this->ifeel_;
+      return encode_state(state);
     }
 
-    void set_bits(remote_base::RemoteTransmitData &data, uint8_t byte, uint32_t bit_mark, uint32_t one_space, uint32_t zero_space, uint8_t length)
+    void GreeIRClimate::setup()
     {
-      // Set data bits
-      for (uint8_t j = 0; j < length; j++)
+      ClimateIR::setup();
+
+      if (this->restore_last_sent_)
+      {
+        this->last_sent_pref_ =
+            global_preferences->make_preference<uint64_t>(this->get_object_id_hash() ^ LAST_SENT_PREF_HASH);
+        uint64_t raw;
+        if (this->last_sent_pref_.load(&raw))
+        {
+          this->last_sent_state_ = GreeFrame(raw);
+          this->has_last_sent_state_ = true;
+          this->saved_last_sent_ = raw;
+          ESP_LOGD(TAG, "Restored last sent frame %016" PRIX64, raw);
+        }
+      }
+
+#ifdef USE_GREEIR_FAST_BOOT
+#ifndef USE_ESP32
+      this->wake_pref_ =
+          global_preferences->make_preference<GreeWakeFrame>(this->get_object_id_hash() ^ WAKE_FRAME_PREF_HASH, false);
+#endif
+      this->transmit_wake_frame_();
+#endif
+
+      if (this->keepalive_interval_ > 0)
+      {
+        this->set_interval("keepalive", this->keepalive_interval_, [this]() {
+          // Any timer in the frame would restart from its rounded up duration, and keepalives
+          // shorter than half an hour would keep it from ever firing; the unit keeps its expiry
+          if (this->has_last_sent_state_)
+            this->transmit_frame_(without_timer(this->last_sent_state_));
+        });
+      }
+
+      if (this->calibrate_)
       {
-        data.mark(bit_mark);
-        bool bit = byte & (1 << j);
-        data.space(bit ? one_space : zero_space);
+        this->calibration_pref_ =
+            global_preferences->make_preference<GreeCalibration>(this->get_object_id_hash() ^ CALIBRATION_PREF_HASH);
+        if (this->calibration_pref_.load(&this->calibration_))
+          ESP_LOGD(TAG, "Restored calibration: marks %+d us, spaces %+d us, jitter %u us", this->calibration_.mark_bias,
+                   this->calibration_.space_bias, this->calibration_.jitter);
+        this->saved_calibration_ = this->calibration_;
       }
+
+      for (auto *sensor : this->diagnostic_sensors_)
+      {
+        if (sensor != nullptr)
+        {
+          this->set_interval("diagnostics", this->diagnostics_interval_, [this]() { this->publish_diagnostics_(); });
+          break;
+        }
+      }
+
+      if (this->ifeel_ && this->sensor_ != nullptr)
+      {
+        this->sensor_->add_on_state_callback([this](float state) { this->on_ifeel_temperature_(state); });
+        if (this->ifeel_max_interval_ > 0)
+        {
+          this->set_interval("ifeel_max", this->ifeel_max_interval_, [this]() {
+            if (millis() - this->ifeel_reported_time_ >= this->ifeel_max_interval_)
+              this->transmit_ifeel_();
+          });
+        }
+      }
+    }
+
+    void GreeIRClimate::publish_diagnostics_()
+    {
+      auto publish = [this](GreeDiagnostic diagnostic, float value) {
+        sensor::Sensor *sensor = this->diagnostic_sensors_[static_cast<size_t>(diagnostic)];
+        if (sensor != nullptr)
+          sensor->publish_state(value);
+      };
+      auto publish_time = [&publish](const GreeTimeStat &stat, GreeDiagnostic min, GreeDiagnostic avg, GreeDiagnostic max) {
+        publish(min, stat.count ? stat.min : NAN);
+        publish(avg, stat.count ? static_cast<float>(stat.total) / stat.count : NAN);
+        publish(max, stat.count ? stat.max : NAN);
+      };
+
+      for (size_t i = 0; i < static_cast<size_t>(GreeDiagnostic::AIRTIME); i++)
+        publish(static_cast<GreeDiagnostic>(i), this->diagnostic_counts_[i]);
+      publish(GreeDiagnostic::AIRTIME, this->airtime_us_ / 1000);
+      publish_time(this->decode_time_, GreeDiagnostic::DECODE_TIME_MIN, GreeDiagnostic::DECODE_TIME_AVG,
+                   GreeDiagnostic::DECODE_TIME_MAX);
+      publish_time(this->encode_time_, GreeDiagnostic::ENCODE_TIME_MIN, GreeDiagnostic::ENCODE_TIME_AVG,
+                   GreeDiagnostic::ENCODE_TIME_MAX);
+
+      // Timings describe the last period only; counters keep growing
+      this->decode_time_.reset();
+      this->encode_time_.reset();
+    }
+
+    void GreeIRClimate::on_ifeel_temperature_(float temperature)
+    {
+      if (std::isnan(temperature))
+        return;
+      this->ifeel_temperature_ = temperature;
+
+      if (!std::isnan(this->ifeel_reported_temperature_) &&
+          std::fabs(temperature - this->ifeel_reported_temperature_) < this->ifeel_delta_)
+        return;
+
+      // Crossed the delta: report now, or once the minimum interval has passed
+      const uint32_t elapsed = millis() - this->ifeel_reported_time_;
+      if (std::isnan(this->ifeel_reported_temperature_) || elapsed >= this->ifeel_min_interval_)
+        this->transmit_ifeel_();
+      else
+        this->set_timeout("ifeel", this->ifeel_min_interval_ - elapsed, [this]() { this->transmit_ifeel_(); });
+    }
+
+    void GreeIRClimate::transmit_ifeel_()
+    {
+      if (std::isnan(this->ifeel_temperature_) || this->mode == climate::CLIMATE_MODE_OFF)
+        return;
+
+      const float clamped = std::max(0.0f, std::min(this->ifeel_temperature_, 63.0f));
+      const uint8_t temperature = static_cast<uint8_t>(std::lround(clamped));
+      ESP_LOGD(TAG, "Sending iFeel room temperature: %u°C", temperature);
+
+      auto transmit = this->transmitter_->transmit();
+      auto data = transmit.get_data();
+      data->set_carrier_frequency(GREE_IR_FREQUENCY);
+      GreeTransmitDataSink sink(data);
+      this->encode_ifeel_(temperature, sink);
+      this->count_(GreeDiagnostic::FRAMES_TRANSMITTED);
+      this->airtime_us_ += sink.get_airtime();
+
+      this->ifeel_reported_temperature_ = this->ifeel_temperature_;
+      this->ifeel_reported_time_ = millis();
+      transmit.perform();
     }
 
-    void set_bytes(remote_base::RemoteTransmitData &data, uint8_t remote_state[], uint32_t bit_mark, uint32_t one_space, uint32_t zero_space, uint8_t length, uint8_t offset)
+    void GreeIRClimate::transmit_state()
     {
-      // Set data bits
-      for (uint8_t i = offset; i < length + offset; i++)
+      const GreeFrame frame = this->get_state_to_send();
+
+      if (this->has_last_sent_state_ && frame == this->last_sent_state_)
       {
-        set_bits(data, remote_state[i], bit_mark, one_space, zero_space, 8);
+        ESP_LOGV(TAG, "State unchanged, skipping transmission");
+        return;
       }
+
+      this->transmit_frame_(frame);
     }
 
-    void GreeIRClimate::get_state_to_send(uint8_t remote_state[])
+    void GreeIRClimate::transmit_frame_(GreeFrame frame, bool whole)
     {
-      // Placeholder implementation: returns a static dummy array
-      // uint8_t remote_state[GREE_STATE_FRAME_SIZE] = {0};
-      GreeProtocol &gree_state = *reinterpret_cast<GreeProtocol *>(remote_state);
-
-      if (this->mode != climate::CLIMATE_MODE_OFF)
+      ESP_LOGD(TAG, "Sending Gree frame: %02X %02X %02X %02X %02X %02X %02X %02X",
+               frame.get_byte(0), frame.get_byte(1), frame.get_byte(2), frame.get_byte(3),
+               frame.get_byte(4), frame.get_byte(5), frame.get_byte(6), frame.get_byte(7));
+
+      // The unit drops iFeel readings while off, so report again once it is switched on
+      const bool powering_on = frame.get(GreeFrame::POWER) &&
+                               !(this->has_last_sent_state_ && this->last_sent_state_.get(GreeFrame::POWER));
+      this->set_last_sent_state_(frame);
+      // The state changed since the last frame received, so a repeat of it is news again
+      this->has_last_received_state_ = false;
+      // The unit re-arms its timer with what the frame carries, which is the remaining time
+      // rounded up to a half hour; expect it to fire when the unit will
+      const uint16_t timer = decode_state(frame).timer;
+      if (timer > 0)
+        this->track_timer_(timer);
+
+      if (this->async_transmit_ && !whole)
       {
-        gree_state.Power = GREE_POWER_ON;
-        gree_state.Mode = this->operation_mode_();
+        // Send the first copy now and the rest from loop(), one per iteration.
+        // A newer frame replaces whatever is left of the previous burst.
+        this->burst_frame_ = frame;
+        this->burst_remaining_ = this->repeat_ - 1;
+        this->transmit_copies_(frame, 1);
+        if (this->burst_remaining_ == 0)
+          this->transmit_complete_callback_.call();
       }
       else
       {
-        gree_state.Power = GREE_POWER_OFF;
+        this->burst_remaining_ = 0;
+        this->transmit_copies_(frame, this->repeat_);
+        this->transmit_complete_callback_.call();
       }
 
-      gree_state.Fan = this->fan_speed_();
-      gree_state.Temp = this->target_temperature - GREE_TEMP_MIN;
-      gree_state.SwingAuto = this->swing_auto_();
-      gree_state.SwingV = this->vertical_swing_();
-      gree_state.SwingH = this->horizontal_swing_();
-      gree_state.Sleep = (this->preset == climate::CLIMATE_PRESET_SLEEP) ? 1 : 0;
-      gree_state.ModelA = (this->get_model() == GreeIRModel::YAW1F || this->get_model() == GreeIRModel::YAC1FB9) ? 1 : 0;
-      gree_state.WiFi = this->wifi_function_ ? 1 : 0;
-      gree_state.unknown1 = 0b0101; // Don't know why
-      gree_state.unknown2 = 0b100;  // Don't know why
-      gree_state.Sum = calcBlockChecksum(gree_state.remote_state, GREE_STATE_FRAME_SIZE);
-      gree_state.Light = 1; // Light on
+      if (this->ifeel_ && powering_on)
+        this->set_timeout("ifeel", 500, [this]() { this->transmit_ifeel_(); });
 
-      ESP_LOGD(TAG, "Sending Gree frame: %02X %02X %02X %02X %02X %02X %02X %02X",
-               remote_state[0], remote_state[1], remote_state[2], remote_state[3],
-               remote_state[4], remote_state[5], remote_state[6], remote_state[7]);
+      for (auto *member : this->group_members_)
+        member->apply_group_frame_(frame);
     }
 
-    void GreeIRClimate::transmit_state()
+#ifdef USE_GREEIR_FAST_BOOT
+    void GreeIRClimate::send_on_wake(const climate::ClimateCall &call)
     {
+      // Build the frame from a scratch copy of the state; the entity itself is unchanged until it is sent
+      const climate::ClimateMode mode = this->mode;
+      const float target_temperature = this->target_temperature;
+      const auto fan_mode = this->fan_mode;
+      const climate::ClimateSwingMode swing_mode = this->swing_mode;
+      const auto preset = this->preset;
+      this->apply_call_(call);
+      const GreeFrame frame = this->get_state_to_send();
+      this->mode = mode;
+      this->target_temperature = target_temperature;
+      this->fan_mode = fan_mode;
+      this->swing_mode = swing_mode;
+      this->preset = preset;
+
+      this->save_wake_frame_(this->get_object_id_hash() ^ WAKE_FRAME_PREF_HASH, frame.raw());
+      ESP_LOGD(TAG, "Stored frame %016" PRIX64 " for the next wake", frame.raw());
+    }
 
-      // Determine timing based on model
-      uint32_t header_mark = GREE_HEADER_MARK;
-      uint32_t header_space = GREE_HEADER_SPACE;
-      uint32_t bit_mark = GREE_BIT_MARK;
-      uint32_t message_space = GREE_MESSAGE_SPACE;
+    void GreeIRClimate::transmit_wake_frame_()
+    {
+      uint64_t raw;
+      if (!this->load_wake_frame_(this->get_object_id_hash() ^ WAKE_FRAME_PREF_HASH, raw))
+        return;
+      this->clear_wake_frame_(this->get_object_id_hash() ^ WAKE_FRAME_PREF_HASH);
+
+      const GreeFrame frame(raw);
+      ESP_LOGD(TAG, "Sending stored wake frame");
+      // Every copy goes out now: the node may sleep again before loop() would send the rest
+      this->transmit_frame_(frame, true);
+      this->sent_wake_frame_ = true;
+      this->parse_state_frame_(frame);
+    }
+#endif
 
-      switch (this->model_)
-      {
-      case GreeIRModel::YAC1FB9:
-        header_space = GREE_YAC1FB9_HEADER_SPACE;
-        message_space = GREE_YAC1FB9_MESSAGE_SPACE;
-        break;
-      case GreeIRModel::YAW1F:
-      case GreeIRModel::YBOFB:
-        header_mark = GREE_YAC_HEADER_MARK;
-        header_space = GREE_YAC_HEADER_SPACE;
-        bit_mark = GREE_YAC_BIT_MARK;
-        break;
-      default:
-        break;
-      }
+    void GreeIRClimate::set_timer(uint32_t minutes)
+    {
+      minutes = std::min<uint32_t>((minutes + 29) / 30 * 30, GREE_TIMER_MAX);
+      ESP_LOGD(TAG, "Setting onboard timer: %" PRIu32 " min", minutes);
+      this->track_timer_(minutes);
+      this->transmit_state();
+    }
+
+    uint32_t GreeIRClimate::get_timer_remaining() const
+    {
+      if (!this->timer_running_)
+        return 0;
+      const int32_t left = static_cast<int32_t>(this->timer_expiry_ - millis());
+      if (left <= 0)
+        return 0;
+      return (static_cast<uint32_t>(left) + 59999) / 60000;
+    }
 
-      uint8_t remote_state[GREE_STATE_FRAME_SIZE] = {0};
-      this->get_state_to_send(remote_state);
+    void GreeIRClimate::track_timer_(uint32_t minutes)
+    {
+      this->timer_running_ = minutes > 0;
+      this->timer_expiry_ = millis() + minutes * 60000;
+      this->timer_power_ = this->mode != climate::CLIMATE_MODE_OFF;
+      if (minutes == 0)
+        this->cancel_timeout("timer");
+      else
+        this->set_timeout("timer", minutes * 60000, [this]() { this->on_timer_expired_(); });
+    }
+
+    void GreeIRClimate::on_timer_expired_()
+    {
+      this->timer_running_ = false;
+      if (this->mode == climate::CLIMATE_MODE_OFF)
+        this->mode = this->resume_mode_;
+      else
+        this->mode = climate::CLIMATE_MODE_OFF;
+      ESP_LOGD(TAG, "Onboard timer fired, unit is now %s", this->mode == climate::CLIMATE_MODE_OFF ? "off" : "on");
 
+      // The unit switched by itself; record what it now holds without telling it again
+      this->set_last_sent_state_(this->get_state_to_send());
+      this->publish_state();
+    }
+
+    void GreeIRClimate::set_last_sent_state_(GreeFrame frame)
+    {
+      this->last_sent_state_ = frame;
+      this->has_last_sent_state_ = true;
+      if (!this->restore_last_sent_)
+        return;
+
+      // Only the state a burst of changes settles on is written
+      this->set_timeout("save_last_sent", LAST_SENT_SAVE_DELAY_MS, [this]() {
+        const uint64_t raw = this->last_sent_state_.raw();
+        if (raw == this->saved_last_sent_)
+          return;
+        this->last_sent_pref_.save(&raw);
+        this->saved_last_sent_ = raw;
+      });
+    }
+
+    void GreeIRClimate::apply_group_frame_(GreeFrame frame)
+    {
+      ESP_LOGD(TAG, "Following group frame");
+      this->parse_state_frame_(frame);
+      this->set_last_sent_state_(frame);
+      this->has_last_received_state_ = false;
+    }
+
+    void GreeIRClimate::transmit_copies_(GreeFrame frame, uint8_t count)
+    {
       // Build IR data
       auto transmit = this->transmitter_->transmit();
       auto data = transmit.get_data();
 
       data->set_carrier_frequency(GREE_IR_FREQUENCY);
 
-      for (int i = 0; i < this->repeat_; i++)
-      {
-        // Header
-        data->mark(header_mark);
-        data->space(header_space);
-
-        set_bytes(*data, remote_state, bit_mark, GREE_ONE_SPACE, GREE_ZERO_SPACE, 4, 0); // block 1
-        set_bits(*data, 0b010, bit_mark, GREE_ONE_SPACE, GREE_ZERO_SPACE, 3);            // block footer
-        set_bits(*data, 0b1, bit_mark, message_space, message_space, 1);                 // message space
-        set_bytes(*data, remote_state, bit_mark, GREE_ONE_SPACE, GREE_ZERO_SPACE, 4, 4); // block 2
-        set_bits(*data, 0b1, bit_mark, message_space, message_space, 1);                 // message space
-      }
-
-      this->last_transmit_time_ = millis();
+      // One frame is encoded and the transmitter replays it, so memory doesn't grow with `count`.
+      // Every frame ends in its message space, so the copies need no extra gap.
+      GreeTransmitDataSink sink(data);
+      const uint32_t encode_start = micros();
+      this->encode_(frame, sink, 1);
+      this->encode_time_.add(micros() - encode_start);
+      transmit.set_send_times(count);
+      transmit.set_send_wait(0);
+
+      const uint32_t airtime = sink.get_airtime() * count;
+      this->diagnostic_counts_[static_cast<size_t>(GreeDiagnostic::FRAMES_TRANSMITTED)] += count;
+      this->airtime_us_ += airtime;
+
+      // Our own reflections of this burst can arrive until it is off the air, plus the receiver's
+      // idle timeout and dispatch. Only copies of this frame are dropped inside that window.
+      // The burst is on the group members' receivers too, and each copy an async burst sends
+      // from loop() extends the window for them as it does for us.
+      this->set_echo_window_(millis(), airtime / 1000 + ECHO_MARGIN_MS);
+      for (auto *member : this->group_members_)
+        member->set_echo_window_(this->echo_start_, this->echo_window_);
       transmit.perform();
     }
 
-    bool get_bits(remote_base::RemoteReceiveData &data, uint8_t &byte, uint32_t bit_mark, uint32_t one_space, uint32_t zero_space, uint8_t length)
+    void GreeIRClimate::loop()
     {
-      byte = 0;
-      for (uint8_t j = 0; j < length; j++)
-      {
-        if (data.expect_item(bit_mark, one_space))
-        {
-          byte |= (1 << j);
-        }
-        else if (data.expect_item(bit_mark, zero_space))
-        {
-          byte |= (0 << j);
-        }
-        else
-        {
-          ESP_LOGV(TAG, "Bit %d failed. stream index=%d", j, data.get_index());
-          return false;
-        }
-      }
-      return true;
-    }
+      if (this->burst_remaining_ == 0)
+        return;
 
-    bool get_bytes(remote_base::RemoteReceiveData &data, uint8_t remote_state[], uint32_t bit_mark, uint32_t one_space, uint32_t zero_space, uint8_t length, uint8_t offset)
-    { // Read data bits
-      for (uint8_t i = offset; i < length + offset; i++)
-      {
-        uint8_t data_byte = 0;
-        get_bits(data, data_byte, bit_mark, one_space, zero_space, 8);
-        remote_state[i] = data_byte;
-      }
-      return true;
+      this->transmit_copies_(this->burst_frame_, 1);
+      if (--this->burst_remaining_ == 0)
+        this->transmit_complete_callback_.call();
     }
 
     bool GreeIRClimate::on_receive(remote_base::RemoteReceiveData data)
     {
-      if (millis() - this->last_transmit_time_ < 500)
+      const auto &raw = data.get_raw_data();
+      const GreeTolerance tolerance = data.get_tolerance_mode() == remote_base::TOLERANCE_MODE_PERCENTAGE
+                                          ? GreeTolerance{data.get_tolerance(), 0}
+                                          : GreeTolerance{0, data.get_tolerance()};
+      if (!this->matches(raw, tolerance))
       {
-        ESP_LOGV(TAG, "Blocked receive because of recent transmission");
+        this->count_(GreeDiagnostic::PREFILTER_REJECTS);
+        if (this->recorder_ && this->record_rejected_)
+          this->recorder_->record(millis(), raw.data(), raw.size(), false, GreeDecodeStage::HEADER);
         return false;
       }
 
-      auto raw = data.get_raw_data();
       ESP_LOGV(TAG, "Raw data has %zu items.", raw.size());
       for (size_t i = 0; i < raw.size(); i++)
       {
-        ESP_LOGVV(TAG, "[%03d] %d", i, raw[i]);
+        ESP_LOGVV(TAG, "[%03zu] %" PRId32, i, raw[i]);
       }
 
-      if (raw.size() < 130)
+      // Windows fitted to the learned jitter are tried first. A capture outside them is retried
+      // at the receiver's tolerance, so frames still decode, and are learned from, if it grew.
+      const bool learned = this->calibration_.jitter > 0;
+      GreePulseSource source(raw.data(), raw.size(), learned ? gree_learned_tolerance(this->calibration_) : tolerance);
+      source.set_calibration(this->calibration_);
+      GreeFrame frame;
+      const uint32_t decode_start = micros();
+      GreeDecodeStage stage = this->decode_(source, frame);
+      if (stage != GreeDecodeStage::OK && learned)
       {
-        ESP_LOGV(TAG, "Received data too short: %zu items", raw.size());
-        return false;
+        source = GreePulseSource(raw.data(), raw.size(), tolerance);
+        source.set_calibration(this->calibration_);
+        stage = this->decode_(source, frame);
       }
-      if (raw.size() > 150)
+      this->decode_time_.add(micros() - decode_start);
+      if (this->recorder_)
+        this->recorder_->record(millis(), raw.data(), raw.size(), true, stage);
+      if (stage != GreeDecodeStage::OK)
       {
-        ESP_LOGV(TAG, "Received data too long: %zu items", raw.size());
+        this->count_(gree_decode_stage_diagnostic(stage));
+        ESP_LOGD(TAG, "%s parsing failed at data index: %zu", gree_decode_stage_to_string(stage), source.get_index());
         return false;
       }
+      // A frame only counts as decoded once its checksum passes
+      this->count_(frame.is_checksum_valid() ? GreeDiagnostic::FRAMES_DECODED : GreeDiagnostic::CHECKSUM_ERRORS);
 
-      uint32_t ir_frequency = GREE_IR_FREQUENCY;
-      uint32_t header_mark = GREE_HEADER_MARK;
-      uint32_t header_space = GREE_HEADER_SPACE;
-      uint32_t bit_mark = GREE_BIT_MARK;
-      uint32_t one_space = GREE_ONE_SPACE;
-      uint32_t zero_space = GREE_ZERO_SPACE;
-      uint32_t message_space = GREE_MESSAGE_SPACE;
-
-      if (this->model_ == GreeIRModel::YAC1FB9)
+      const uint32_t now = millis();
+      if (this->has_last_sent_state_ && now - this->echo_start_ < this->echo_window_ &&
+          frame == this->last_sent_state_)
       {
-        header_space = GREE_YAC1FB9_HEADER_SPACE;
-        message_space = GREE_YAC1FB9_MESSAGE_SPACE;
-      }
-      else if (this->model_ == GreeIRModel::YAW1F || this->model_ == GreeIRModel::YBOFB)
-      {
-        header_mark = GREE_YAC_HEADER_MARK;
-        header_space = GREE_YAC_HEADER_SPACE;
-        bit_mark = GREE_YAC_BIT_MARK;
+        ESP_LOGV(TAG, "Ignored echo of our own transmission");
+        return true;
       }
 
-      // Check if this looks like a Gree IR signal
-      if (!data.expect_item(header_mark, header_space))
+      // Echoes are not learned from: they measure our own emitter's reflection, not the remote
+      if (this->calibrate_ && frame.is_checksum_valid())
+        this->learn_calibration_(raw, frame, source.get_tolerance());
+
+      // Repeats of the frame just handled change nothing; only count them
+      if (this->has_last_received_state_ && now - this->last_received_time_ < this->dedup_window_ &&
+          frame == this->last_received_state_)
       {
-        ESP_LOGD(TAG, "Header fail");
-        return false;
+        this->last_received_time_ = now;
+        this->duplicate_frames_++;
+        ESP_LOGV(TAG, "Duplicate frame ignored (%" PRIu32 " so far)", this->duplicate_frames_);
+        return true;
       }
 
-      uint8_t remote_state[GREE_STATE_FRAME_SIZE];
-      if (!get_bytes(data, remote_state, bit_mark, one_space, zero_space, 4, 0))
-      {
-        ESP_LOGD(TAG, "Block 1 parsing failed");
+      ESP_LOGV(TAG, "Received Gree frame: %02X %02X %02X %02X %02X %02X %02X %02X",
+               frame.get_byte(0), frame.get_byte(1), frame.get_byte(2), frame.get_byte(3),
+               frame.get_byte(4), frame.get_byte(5), frame.get_byte(6), frame.get_byte(7));
+
+      // Parse the received data
+      if (!this->parse_state_frame_(frame))
         return false;
-      }
 
-      uint8_t footer_data_byte = 0;
-      get_bits(data, footer_data_byte, bit_mark, one_space, zero_space, 3);
-      if (footer_data_byte != 0b010)
+      this->last_received_state_ = frame;
+      this->has_last_received_state_ = true;
+      this->last_received_time_ = now;
+
+      // The unit now holds the remote's state; re-asserting it needs no transmission
+      this->set_last_sent_state_(frame);
+      return true;
+    }
+
+    void GreeIRClimate::dump_captures()
+    {
+      if (!this->recorder_)
       {
-        ESP_LOGD(TAG, "Block Footer failed at data index: %d", data.get_index());
-        ESP_LOGD(TAG, "Expected 0b010, got %d", footer_data_byte);
-        return false;
+        ESP_LOGW(TAG, "Capture recording is not enabled");
+        return;
       }
 
-      if (!data.expect_item(bit_mark, message_space))
+      static const size_t VALUES_PER_LINE = 16;
+      std::vector<int32_t> timings;
+      const size_t count = this->recorder_->size();
+      for (size_t i = 0; i < count; i++)
       {
-        ESP_LOGD(TAG, "Message space failed at data index: %d", data.get_index());
-        return false;
+        const auto &capture = this->recorder_->get(i);
+        GreeCaptureRecorder::expand(capture, timings);
+        ESP_LOGI(TAG, "Capture %zu/%zu at %" PRIu32 " ms, %zu timings: %s", i + 1, count, capture.time, timings.size(),
+                 !capture.matched                      ? "rejected by prefilter"
+                 : capture.stage == GreeDecodeStage::OK ? "decoded"
+                                                       : gree_decode_stage_to_string(capture.stage));
+        for (size_t j = 0; j < timings.size(); j += VALUES_PER_LINE)
+        {
+          char line[VALUES_PER_LINE * 13 + 1];
+          size_t length = 0;
+          for (size_t k = j; k < std::min(j + VALUES_PER_LINE, timings.size()); k++)
+            length += snprintf(line + length, sizeof(line) - length, "%" PRId32 ", ", timings[k]);
+          ESP_LOGI(TAG, "  %s", line);
+        }
       }
+    }
 
-      if (!get_bytes(data, remote_state, bit_mark, one_space, zero_space, 4, 4))
+    void GreeIRClimate::learn_calibration_(const remote_base::RawTimings &raw, GreeFrame frame, GreeTolerance tolerance)
+    {
+      // Compare the first frame of the capture with its nominal timings. The last space is
+      // left out, as the receiver's idle timeout cuts it short.
+      GreeArraySink<GREE_FRAME_ITEMS> nominal;
+      this->encode_(frame, nominal, 1);
+      const size_t count = std::min(nominal.size() - 1, raw.size());
+      GreeCalibration sample = this->calibration_;
+      if (!gree_measure_bias(raw.data(), nominal.data(), count, sample, tolerance))
+        return;
+
+      auto update = [](int16_t &bias, int32_t measured) {
+        const int32_t value = bias + (measured - bias) / CALIBRATION_WEIGHT;
+        bias = std::max(-GREE_MAX_BIAS, std::min(value, GREE_MAX_BIAS));
+      };
+      update(this->calibration_.mark_bias, sample.mark_bias);
+      update(this->calibration_.space_bias, sample.space_bias);
+      // The first measurement sets the jitter outright, so the windows aren't fitted to a fraction of it
+      const int32_t jitter = this->calibration_.jitter == 0
+                                 ? sample.jitter
+                                 : this->calibration_.jitter + (sample.jitter - this->calibration_.jitter) / CALIBRATION_WEIGHT;
+      this->calibration_.jitter = std::min(jitter, GREE_MAX_BIAS);
+      ESP_LOGV(TAG, "Measured marks %+d us, spaces %+d us, jitter %u us; calibration now %+d us, %+d us, %u us",
+               sample.mark_bias, sample.space_bias, sample.jitter, this->calibration_.mark_bias,
+               this->calibration_.space_bias, this->calibration_.jitter);
+
+      if (std::abs(this->calibration_.mark_bias - this->saved_calibration_.mark_bias) >= CALIBRATION_SAVE_STEP ||
+          std::abs(this->calibration_.space_bias - this->saved_calibration_.space_bias) >= CALIBRATION_SAVE_STEP ||
+          std::abs(this->calibration_.jitter - this->saved_calibration_.jitter) >= CALIBRATION_SAVE_STEP)
       {
-        ESP_LOGD(TAG, "Block 2 parsing failed");
-        return false;
+        ESP_LOGD(TAG, "Calibration: marks %+d us, spaces %+d us, jitter %u us", this->calibration_.mark_bias,
+                 this->calibration_.space_bias, this->calibration_.jitter);
+        this->calibration_pref_.save(&this->calibration_);
+        this->saved_calibration_ = this->calibration_;
       }
-
-      ESP_LOGV(TAG, "Received Gree frame: %02X %02X %02X %02X %02X %02X %02X %02X",
-               remote_state[0], remote_state[1], remote_state[2], remote_state[3],
-               remote_state[4], remote_state[5], remote_state[6], remote_state[7]);
-
-      // Parse the received data
-      return this->parse_state_frame_(remote_state);
     }
 
-    bool GreeIRClimate::parse_state_frame_(const uint8_t frame[])
+    bool GreeIRClimate::parse_state_frame_(GreeFrame frame)
     {
-
-      const GreeProtocol &parsed_frame = *reinterpret_cast<const GreeProtocol *>(frame);
-      uint8_t checksum = calcBlockChecksum(frame, GREE_STATE_FRAME_SIZE);
+      uint8_t checksum = frame.calc_checksum();
+      uint8_t received_checksum = frame.get(GreeFrame::SUM);
       ESP_LOGV(TAG, "Calculated checksum: %02X", checksum);
-      ESP_LOGV(TAG, "Received checksum: %02X", parsed_frame.Sum);
+      ESP_LOGV(TAG, "Received checksum: %02X", received_checksum);
 
-      if (checksum != parsed_frame.Sum)
+      if (checksum != received_checksum)
       {
         if (this->check_checksum_)
         {
-          ESP_LOGW(TAG, "Checksum mismatch: expected %02X, got %02X", checksum, parsed_frame.Sum);
+          ESP_LOGW(TAG, "Checksum mismatch: expected %02X, got %02X", checksum, received_checksum);
           return false;
         }
         else
         {
-          ESP_LOGD(TAG, "Checksum mismatch: expected %02X, got %02X. Ignoring checksum...", checksum, parsed_frame.Sum);
+          ESP_LOGD(TAG, "Checksum mismatch: expected %02X, got %02X. Ignoring checksum...", checksum, received_checksum);
         }
       }
 
+      const GreeState parsed_frame = decode_state(frame);
+
       // Parse power state
-      if (parsed_frame.Power == GREE_POWER_ON)
+      if (parsed_frame.power)
       {
         // Parse mode
-        switch (parsed_frame.Mode)
+        climate::ClimateMode mode;
+        if (!gree_decode(GREE_MODE_MAP, parsed_frame.mode, mode))
         {
-        case GREE_MODE_COOL:
-          this->mode = climate::CLIMATE_MODE_COOL;
-          break;
-        case GREE_MODE_HEAT:
-          this->mode = climate::CLIMATE_MODE_HEAT;
-          break;
-        case GREE_MODE_AUTO:
-          this->mode = climate::CLIMATE_MODE_HEAT_COOL;
-          break;
-        case GREE_MODE_DRY:
-          this->mode = climate::CLIMATE_MODE_DRY;
-          break;
-        case GREE_MODE_FAN:
-          this->mode = climate::CLIMATE_MODE_FAN_ONLY;
-          break;
-        default:
-          ESP_LOGW(TAG, "Unknown mode: %d", mode);
+          ESP_LOGW(TAG, "Unknown mode: %d", parsed_frame.mode);
           return false;
         }
+        this->mode = mode;
+        this->resume_mode_ = mode;
         ESP_LOGV(TAG, "Parsed mode: %d", this->mode);
 
         // Parse temperature
-        this->target_temperature = parsed_frame.Temp + GREE_TEMP_MIN;
-        ESP_LOGV(TAG, "Parsed target temperature: %d", this->target_temperature);
+        this->target_temperature = parsed_frame.temperature;
+        ESP_LOGV(TAG, "Parsed target temperature: %.0f", this->target_temperature);
 
         // Parse fan speed
-        // uint8_t fan = (frame[0] & 0x30) >> 4;
-        switch (parsed_frame.Fan)
+        climate::ClimateFanMode fan_mode;
+        if (gree_decode(GREE_FAN_MAP, parsed_frame.fan, fan_mode))
         {
-        case GREE_FAN_AUTO:
-          this->fan_mode = climate::CLIMATE_FAN_AUTO;
-          break;
-        case GREE_FAN_LOW:
-          this->fan_mode = climate::CLIMATE_FAN_LOW;
-          break;
-        case GREE_FAN_MEDIUM:
-          this->fan_mode = climate::CLIMATE_FAN_MEDIUM;
-          break;
-        case GREE_FAN_HIGH:
-          this->fan_mode = climate::CLIMATE_FAN_HIGH;
-          break;
-        default:
-          ESP_LOGW(TAG, "Unknown fan speed: %d", parsed_frame.Fan);
-          break;
+          this->fan_mode = fan_mode;
+          ESP_LOGV(TAG, "Parsed fan mode: %d", fan_mode);
         }
-        ESP_LOGV(TAG, "Parsed fan mode: %d", this->fan_mode);
+        else
+          ESP_LOGW(TAG, "Unknown fan speed: %d", parsed_frame.fan);
 
         // Parse swing modes
-        uint8_t vswing = parsed_frame.SwingV;
-        uint8_t hswing = parsed_frame.SwingH;
-        // uint8_t vswing = frame[4] & 0x0F;
-        // uint8_t hswing = (frame[4] & 0xF0) >> 4;
+        uint8_t vswing = parsed_frame.swing_v;
+        uint8_t hswing = parsed_frame.swing_h;
         ESP_LOGVV(TAG, "unparsed vswing: %d", vswing);
         ESP_LOGVV(TAG, "unparsed hswing: %d", hswing);
 
-        if (vswing == GREE_VDIR_SWING && hswing == GREE_HDIR_SWING)
-        {
-          this->swing_mode = climate::CLIMATE_SWING_BOTH;
-        }
-        else if (vswing == GREE_VDIR_SWING)
-        {
-          this->swing_mode = climate::CLIMATE_SWING_VERTICAL;
-        }
-        else if (hswing == GREE_HDIR_SWING)
-        {
-          this->swing_mode = climate::CLIMATE_SWING_HORIZONTAL;
-        }
-        else
-        {
-          this->swing_mode = climate::CLIMATE_SWING_OFF;
-        }
+        climate::ClimateSwingMode swing_mode = climate::CLIMATE_SWING_OFF;
+        gree_decode(GREE_SWING_MAP, (vswing == GREE_VDIR_SWING) | ((hswing == GREE_HDIR_SWING) << 1), swing_mode);
+        this->swing_mode = swing_mode;
 
         ESP_LOGV(TAG, "parsed swing: %d", this->swing_mode);
 
         // Parse presets
-        // if (frame[0] & (1 << 7))
-        if (parsed_frame.Sleep)
+        if (parsed_frame.sleep)
         {
           this->preset = climate::CLIMATE_PRESET_SLEEP;
         }
@@ -383,93 +742,77 @@ namespace esphome
         {
           this->preset = climate::CLIMATE_PRESET_NONE;
         }
-        ESP_LOGV(TAG, "parsed preset: %d", this->preset);
+        ESP_LOGV(TAG, "parsed preset: %d", *this->preset);
       }
       else
       {
         this->mode = climate::CLIMATE_MODE_OFF;
+        // An off frame with an on timer carries the mode the unit will start in
+        climate::ClimateMode mode;
+        if (parsed_frame.timer > 0 && gree_decode(GREE_MODE_MAP, parsed_frame.mode, mode))
+          this->resume_mode_ = mode;
+      }
+
+      // Follow timers set or cancelled elsewhere; the frame only resolves half hours
+      const uint32_t remaining = this->get_timer_remaining();
+      if (parsed_frame.timer == 0 ? remaining > 0 : std::abs(int32_t(parsed_frame.timer) - int32_t(remaining)) >= 30)
+      {
+        ESP_LOGD(TAG, "Parsed onboard timer: %u min", parsed_frame.timer);
+        this->track_timer_(parsed_frame.timer);
+      }
+
+      // The remote's state supersedes changes still waiting to be sent
+      if (this->transmit_pending_)
+      {
+        this->cancel_timeout("coalesce");
+        this->transmit_pending_ = false;
       }
 
       this->publish_state();
       return true;
     }
 
+    bool GreeIRClimate::restore_detected_model_()
+    {
+      this->model_pref_ = global_preferences->make_preference<GreeIRModel>(this->get_object_id_hash() ^ DETECTED_MODEL_PREF_HASH);
+      GreeIRModel model;
+      if (!this->model_pref_.load(&model) || model == GreeIRModel::AUTO)
+        return false;
+      ESP_LOGD(TAG, "Restored detected model %s", gree_model_to_string(model));
+      this->model_ = model;
+      return true;
+    }
+
+    void GreeIRClimate::lock_detected_model_(GreeIRModel model)
+    {
+      ESP_LOGI(TAG, "Detected model %s", gree_model_to_string(model));
+      this->model_ = model;
+      this->model_pref_.save(&model);
+    }
+
     uint8_t GreeIRClimate::operation_mode_()
     {
-      switch (this->mode)
-      {
-      case climate::CLIMATE_MODE_COOL:
-        return GREE_MODE_COOL;
-      case climate::CLIMATE_MODE_HEAT:
-        return GREE_MODE_HEAT;
-      case climate::CLIMATE_MODE_HEAT_COOL:
-        return GREE_MODE_AUTO;
-      case climate::CLIMATE_MODE_DRY:
-        return GREE_MODE_DRY;
-      case climate::CLIMATE_MODE_FAN_ONLY:
-        return GREE_MODE_FAN;
-      case climate::CLIMATE_MODE_OFF:
-      default:
-        return GREE_MODE_OFF;
-      }
+      return gree_encode(GREE_MODE_MAP, this->mode, GREE_MODE_OFF);
     }
 
     uint8_t GreeIRClimate::fan_speed_()
     {
-      switch (this->fan_mode.value_or(climate::CLIMATE_FAN_AUTO))
-      {
-      case climate::CLIMATE_FAN_LOW:
-        return GREE_FAN_LOW;
-      case climate::CLIMATE_FAN_MEDIUM:
-        return GREE_FAN_MEDIUM;
-      case climate::CLIMATE_FAN_HIGH:
-        return GREE_FAN_HIGH;
-      case climate::CLIMATE_FAN_AUTO:
-      default:
-        return GREE_FAN_AUTO;
-      }
+      return gree_encode(GREE_FAN_MAP, this->fan_mode.value_or(climate::CLIMATE_FAN_AUTO), GREE_FAN_AUTO);
     }
 
     uint8_t GreeIRClimate::vertical_swing_()
     {
-      switch (this->swing_mode)
-      {
-      case climate::CLIMATE_SWING_VERTICAL:
-      case climate::CLIMATE_SWING_BOTH:
-        return GREE_VDIR_SWING;
-      case climate::CLIMATE_SWING_OFF:
-      case climate::CLIMATE_SWING_HORIZONTAL:
-      default:
-        return GREE_VDIR_MANUAL;
-      }
+      return (gree_encode(GREE_SWING_MAP, this->swing_mode, 0) & 0b01) ? GREE_VDIR_SWING : GREE_VDIR_MANUAL;
     }
 
     uint8_t GreeIRClimate::horizontal_swing_()
     {
-      switch (this->swing_mode)
-      {
-      case climate::CLIMATE_SWING_HORIZONTAL:
-      case climate::CLIMATE_SWING_BOTH:
-        return GREE_HDIR_SWING;
-      case climate::CLIMATE_SWING_OFF:
-      case climate::CLIMATE_SWING_VERTICAL:
-      default:
-        return GREE_HDIR_AUTO;
-      }
+      return (gree_encode(GREE_SWING_MAP, this->swing_mode, 0) & 0b10) ? GREE_HDIR_SWING : GREE_HDIR_MANUAL;
     }
 
     uint8_t GreeIRClimate::swing_auto_()
     {
-      switch (this->swing_mode)
-      {
-      case climate::CLIMATE_SWING_BOTH:
-      case climate::CLIMATE_SWING_HORIZONTAL:
-      case climate::CLIMATE_SWING_VERTICAL:
-        return GREE_SWING_AUTO;
-      case climate::CLIMATE_SWING_OFF:
-      default:
-        return GREE_SWING_MANUAL;
-      }
+      return gree_encode(GREE_SWING_MAP, this->swing_mode, 0) ? GREE_SWING_AUTO : GREE_SWING_MANUAL;
     }
 
     climate::ClimateTraits GreeIRClimate::traits()
@@ -1,97 +1,140 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
 #include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/preferences.h"
 #include "esphome/components/climate_ir/climate_ir.h"
-#include "gree_protocol.h"
+#include "esphome/components/sensor/sensor.h"
+#include "gree_codec.h"
 
 namespace esphome
 {
   namespace greeir
   {
 
-    // Temperature constants
-    const uint8_t GREE_TEMP_MIN = 16; // °C
-    const uint8_t GREE_TEMP_MAX = 30; // °C
-
-    // IR timing constants
-    const uint32_t GREE_IR_FREQUENCY = 38000;
-    const uint32_t GREE_HEADER_MARK = 9000;
-    const uint32_t GREE_HEADER_SPACE = 4000;
-    const uint32_t GREE_BIT_MARK = 620;
-    const uint32_t GREE_ONE_SPACE = 1600;
-    const uint32_t GREE_ZERO_SPACE = 540;
-    const uint32_t GREE_MESSAGE_SPACE = 19000;
-
-    // YAC1FB9 variant timing (some Gree models)
-    const uint32_t GREE_YAC1FB9_HEADER_SPACE = 4500;
-    const uint32_t GREE_YAC1FB9_MESSAGE_SPACE = 19800;
-    const uint32_t GREE_YAC_HEADER_MARK = 6000;
-    const uint32_t GREE_YAC_HEADER_SPACE = 3000;
-    const uint32_t GREE_YAC_BIT_MARK = 650;
-
-    // State frame size
-    const uint8_t GREE_STATE_FRAME_SIZE = 8;
-    const uint8_t GREE_BLOCK_FOOTER_SIZE = 3;
-
-    // Mode constants
-    const uint8_t GREE_MODE_AUTO = 0;
-    const uint8_t GREE_MODE_COOL = 1;
-    const uint8_t GREE_MODE_DRY = 2;
-    const uint8_t GREE_MODE_FAN = 3;
-    const uint8_t GREE_MODE_HEAT = 4;
-    const uint8_t GREE_MODE_ON = 8;
-    const uint8_t GREE_MODE_OFF = 0;
-    // Power constants
-    const uint8_t GREE_POWER_ON = 1;
-    const uint8_t GREE_POWER_OFF = 0;
-
-    // Fan speed constants
-    const uint8_t GREE_FAN_AUTO = 0;
-    const uint8_t GREE_FAN_LOW = 1;
-    const uint8_t GREE_FAN_MEDIUM = 2;
-    const uint8_t GREE_FAN_HIGH = 3;
-    const uint8_t GREE_FAN_TURBO = 0;
-    const uint8_t GREE_FAN_TURBO_BIT = 4;
-
-    // Swing constants - Vertical
-    const uint8_t GREE_VDIR_AUTO = 0;
-    const uint8_t GREE_VDIR_SWING = 1;
-    const uint8_t GREE_VDIR_UP = 2;
-    const uint8_t GREE_VDIR_MUP = 3;
-    const uint8_t GREE_VDIR_MIDDLE = 4;
-    const uint8_t GREE_VDIR_MDOWN = 5;
-    const uint8_t GREE_VDIR_DOWN = 6;
-    const uint8_t GREE_VDIR_MANUAL = 0;
-
-    // Swing constants - Horizontal
-    const uint8_t GREE_HDIR_AUTO = 0;
-    const uint8_t GREE_HDIR_SWING = 1;
-    const uint8_t GREE_HDIR_LEFT = 2;
-    const uint8_t GREE_HDIR_MLEFT = 3;
-    const uint8_t GREE_HDIR_MIDDLE = 4;
-    const uint8_t GREE_HDIR_MRIGHT = 5;
-    const uint8_t GREE_HDIR_RIGHT = 6;
-    const uint8_t GREE_HDIR_MANUAL = 0;
-
-    // Swing constants - Auto
-    const uint8_t GREE_SWING_AUTO = 0;
-    const uint8_t GREE_SWING_MANUAL = 1;
-
-    // Preset constants
-    const uint8_t GREE_PRESET_NONE = 0;
-    const uint8_t GREE_PRESET_SLEEP = 1;
-    const uint8_t GREE_PRESET_SLEEP_BIT = 0;
-
-    // Gree model variants
-    enum class GreeIRModel
+    constexpr GreeMapping<climate::ClimateMode> GREE_MODE_MAP[] = {
+        {climate::CLIMATE_MODE_COOL, GREE_MODE_COOL},
+        {climate::CLIMATE_MODE_HEAT, GREE_MODE_HEAT},
+        {climate::CLIMATE_MODE_HEAT_COOL, GREE_MODE_AUTO},
+        {climate::CLIMATE_MODE_DRY, GREE_MODE_DRY},
+        {climate::CLIMATE_MODE_FAN_ONLY, GREE_MODE_FAN},
+    };
+
+    constexpr GreeMapping<climate::ClimateFanMode> GREE_FAN_MAP[] = {
+        {climate::CLIMATE_FAN_AUTO, GREE_FAN_AUTO},
+        {climate::CLIMATE_FAN_LOW, GREE_FAN_LOW},
+        {climate::CLIMATE_FAN_MEDIUM, GREE_FAN_MEDIUM},
+        {climate::CLIMATE_FAN_HIGH, GREE_FAN_HIGH},
+    };
+
+    /// Swing modes are keyed on whether each axis swings: bit 0 = vertical, bit 1 = horizontal.
+    constexpr GreeMapping<climate::ClimateSwingMode> GREE_SWING_MAP[] = {
+        {climate::CLIMATE_SWING_OFF, 0b00},
+        {climate::CLIMATE_SWING_VERTICAL, 0b01},
+        {climate::CLIMATE_SWING_HORIZONTAL, 0b10},
+        {climate::CLIMATE_SWING_BOTH, 0b11},
+    };
+
+    static_assert(gree_round_trips(GREE_MODE_MAP), "GREE_MODE_MAP must be a bijection");
+    static_assert(gree_round_trips(GREE_FAN_MAP), "GREE_FAN_MAP must be a bijection");
+    static_assert(gree_round_trips(GREE_SWING_MAP), "GREE_SWING_MAP must be a bijection");
+
+    /// Appends encoded pulses to an ESPHome transmit buffer.
+    class GreeTransmitDataSink : public GreePulseSink
+    {
+    public:
+      explicit GreeTransmitDataSink(remote_base::RemoteTransmitData *data) : data_(data) {}
+
+      void reserve(size_t count) override { this->data_->reserve(count); }
+
+      void write(const int32_t *timings, size_t count) override
+      {
+        // Grow the buffer once for the whole write, so item() only stores
+        this->data_->reserve(this->data_->get_data().size() + count);
+        for (size_t i = 0; i < count; i += 2)
+        {
+          const uint32_t mark = timings[i];
+          const uint32_t space = -timings[i + 1];
+          this->data_->item(mark, space);
+          this->airtime_ += mark + space;
+        }
+      }
+
+      /// Total duration of the pulses written so far, in microseconds
+      uint32_t get_airtime() const { return this->airtime_; }
+
+    protected:
+      remote_base::RemoteTransmitData *data_;
+      uint32_t airtime_{0};
+    };
+
+    /// Counters and timings that can be published as diagnostic sensors.
+    enum class GreeDiagnostic : uint8_t
+    {
+      PREFILTER_REJECTS,
+      HEADER_ERRORS,
+      BLOCK_1_ERRORS,
+      FOOTER_ERRORS,
+      MESSAGE_SPACE_ERRORS,
+      BLOCK_2_ERRORS,
+      CHECKSUM_ERRORS,
+      FRAMES_DECODED,
+      FRAMES_TRANSMITTED,
+      AIRTIME,
+      DECODE_TIME_MIN,
+      DECODE_TIME_AVG,
+      DECODE_TIME_MAX,
+      ENCODE_TIME_MIN,
+      ENCODE_TIME_AVG,
+      ENCODE_TIME_MAX,
+      COUNT,
+    };
+
+    /// Min/avg/max of durations in microseconds since the last reset.
+    struct GreeTimeStat
     {
-      GENERIC,
-      YAW1F,
-      YBOFB,
-      YAC1FB9,
-      YT1F
+      uint32_t min{UINT32_MAX};
+      uint32_t max{0};
+      uint64_t total{0};
+      uint32_t count{0};
+
+      void add(uint32_t us)
+      {
+        this->min = std::min(this->min, us);
+        this->max = std::max(this->max, us);
+        this->total += us;
+        this->count++;
+      }
+
+      void reset() { *this = GreeTimeStat{}; }
     };
 
+    /// The counter a decode result is recorded under.
+    inline GreeDiagnostic gree_decode_stage_diagnostic(GreeDecodeStage stage)
+    {
+      switch (stage)
+      {
+      case GreeDecodeStage::HEADER:
+        return GreeDiagnostic::HEADER_ERRORS;
+      case GreeDecodeStage::BLOCK_1:
+        return GreeDiagnostic::BLOCK_1_ERRORS;
+      case GreeDecodeStage::FOOTER:
+        return GreeDiagnostic::FOOTER_ERRORS;
+      case GreeDecodeStage::MESSAGE_SPACE:
+        return GreeDiagnostic::MESSAGE_SPACE_ERRORS;
+      case GreeDecodeStage::BLOCK_2:
+        return GreeDiagnostic::BLOCK_2_ERRORS;
+      case GreeDecodeStage::OK:
+      default:
+        return GreeDiagnostic::FRAMES_DECODED;
+      }
+    }
+
     class GreeIRClimate : public climate_ir::ClimateIR
     {
     public:
@@ -102,33 +145,130 @@ namespace esphome
                                   {climate::CLIMATE_SWING_OFF, climate::CLIMATE_SWING_VERTICAL,
                                    climate::CLIMATE_SWING_HORIZONTAL, climate::CLIMATE_SWING_BOTH}) {}
 
+      void setup() override;
+      void loop() override;
+
       /// Override control to handle all changes in a single call.
       void control(const climate::ClimateCall &call) override;
 
-      /// Set the model for this climate device
-      void set_model(GreeIRModel model) { this->model_ = model; }
-
       /// Get the model
       GreeIRModel get_model() const { return this->model_; }
 
+      /// Cheap check whether a capture looks like a frame of this model, for reuse by
+      /// other receivers. on_receive() runs it before any logging or decoding. With a learned
+      /// calibration, timings are corrected for it and the learned windows are accepted too.
+      bool matches(const remote_base::RawTimings &raw, GreeTolerance tolerance = {}) const
+      {
+        if (this->calibration_.jitter > 0)
+          tolerance = tolerance.merge(gree_learned_tolerance(this->calibration_));
+        return this->matches_(raw.data(), raw.size(), tolerance, this->calibration_);
+      }
+
       /// Enable WiFi function bits (some models)
       void set_wifi_function(bool enable) { this->wifi_function_ = enable; }
       void set_check_checksum(bool enable) { this->check_checksum_ = enable; }
       void set_set_modes(bool enable) { this->set_modes_ = enable; }
       void set_repeat(int8_t repeat) { this->repeat_ = repeat; }
+      /// Merge control() calls arriving within this many milliseconds into one transmission (0 = off)
+      void set_coalesce_window(uint32_t coalesce_window) { this->coalesce_window_ = coalesce_window; }
+      /// Resend the last frame every this many milliseconds, for units that lose state (0 = off)
+      void set_keepalive_interval(uint32_t keepalive_interval) { this->keepalive_interval_ = keepalive_interval; }
+      /// Ignore copies of the last received frame arriving within this many milliseconds of the previous copy
+      void set_dedup_window(uint32_t dedup_window) { this->dedup_window_ = dedup_window; }
+
+      /// Program the unit's onboard timer to toggle power in `minutes` (rounded up to half an hour,
+      /// at most 24 h; 0 cancels). It is sent with the state, and every later state change re-arms
+      /// it with the remaining time rounded up again; keepalives leave it out. Switching power
+      /// through the entity cancels it. When it fires the entity switches power to match without
+      /// transmitting anything.
+      void set_timer(uint32_t minutes);
+      /// Minutes until the onboard timer fires, 0 if it isn't running.
+      uint32_t get_timer_remaining() const;
+
+#ifdef USE_GREEIR_FAST_BOOT
+      /// Store the frame for the state `call` would set, to be sent at the start of the next boot
+      /// (typically a wake from deep sleep), before WiFi or anything after this component is set up.
+      void send_on_wake(const climate::ClimateCall &call);
+      /// True if this boot sent a stored frame, so a battery node can go straight back to sleep.
+      bool sent_wake_frame() const { return this->sent_wake_frame_; }
+#endif
+
+      /// Make `member` follow this entity: every state frame sent here is obeyed by all units in
+      /// range, so members take on its state without encoding or transmitting anything themselves.
+      void add_group_member(GreeIRClimate *member) { this->group_members_.push_back(member); }
+
+      /// Keep the last frame sent across reboots, so an unchanged state isn't sent again after boot
+      void set_restore_last_sent(bool enable) { this->restore_last_sent_ = enable; }
+      /// Keep the last `count` raw captures and their decode result for dump_captures()
+      void set_record_captures(size_t count) { this->recorder_ = std::make_unique<GreeCaptureRecorder>(count); }
+      /// Also record captures the prefilter rejects. Off by default, so other remotes in the
+      /// room don't push the Gree frames that failed to decode out of the recorder.
+      void set_record_rejected(bool enable) { this->record_rejected_ = enable; }
+      /// Log the recorded captures, oldest first, as raw timings that can be replayed with transmit_raw
+      void dump_captures();
+
+      /// Learn the receiver's mark/space skew and jitter from received frames. Captures are
+      /// corrected for the skew and decoded with windows fitted to the jitter.
+      void set_calibration(bool enable) { this->calibrate_ = enable; }
+      /// Send repeated copies of a frame one per loop iteration instead of in a single blocking burst
+      void set_async_transmit(bool enable) { this->async_transmit_ = enable; }
+      /// Called once every copy of a state frame has been sent
+      void add_on_transmit_complete_callback(std::function<void()> &&callback)
+      {
+        this->transmit_complete_callback_.add(std::move(callback));
+      }
+      /// Whether copies of the last state frame are still waiting to be sent
+      bool is_transmitting() const { return this->burst_remaining_ > 0; }
+
+      /// Report the `sensor` reading to the unit with iFeel messages. A report is sent when the
+      /// reading moved by at least `delta` since the last one, but no more often than every
+      /// `min_interval` ms. With `max_interval` set (ms), the reading is also re-sent after
+      /// that long without a report, so the unit doesn't fall back to its own sensor.
+      void set_ifeel(float delta, uint32_t min_interval, uint32_t max_interval)
+      {
+        this->ifeel_ = true;
+        this->ifeel_delta_ = delta;
+        this->ifeel_min_interval_ = min_interval;
+        this->ifeel_max_interval_ = max_interval;
+      }
+
+      /// Number of received frames dropped as repeats of the previous one
+      uint32_t get_duplicate_frames() const { return this->duplicate_frames_; }
+
+      void set_diagnostic_sensor(GreeDiagnostic diagnostic, sensor::Sensor *sensor)
+      {
+        this->diagnostic_sensors_[static_cast<size_t>(diagnostic)] = sensor;
+      }
+      /// Publish the diagnostic sensors every this many milliseconds
+      void set_diagnostics_interval(uint32_t interval) { this->diagnostics_interval_ = interval; }
 
     protected:
       climate::ClimateTraits traits() override;
 
-      /// Transmit via IR the state of this climate controller.
+      /// Transmit via IR the state of this climate controller, unless it matches the last frame sent.
       void transmit_state() override;
+      /// Transmit an already built state frame. With `whole`, every copy is sent now even with
+      /// `async_transmit`.
+      void transmit_frame_(GreeFrame frame, bool whole = false);
+      /// Send `count` copies of `frame`, encoded once and replayed by the transmitter.
+      void transmit_copies_(GreeFrame frame, uint8_t count);
       /// Handle received IR Buffer
       bool on_receive(remote_base::RemoteReceiveData data) override;
 
+      /// Encode `frame` into pulses, `repeat` times over, with the model's codec.
+      virtual void encode_(GreeFrame frame, GreePulseSink &sink, uint8_t repeat) = 0;
+      /// Encode an iFeel room-temperature report with the model's codec.
+      virtual void encode_ifeel_(uint8_t temperature, GreePulseSink &sink) = 0;
+      /// Prefilter a capture with the model's codec.
+      virtual bool matches_(const int32_t *data, size_t size, GreeTolerance tolerance,
+                            GreeCalibration calibration) const = 0;
+      /// Decode a capture of one or more repeated frames from `source` with the model's codec.
+      virtual GreeDecodeStage decode_(GreePulseSource &source, GreeFrame &frame) = 0;
+
       /// Calculate checksum for IR data
       uint8_t checksum_();
 
-      void get_state_to_send(uint8_t remote_state[]);
+      GreeFrame get_state_to_send();
 
       /// Get operation mode for current state
       uint8_t operation_mode_();
@@ -145,15 +285,204 @@ namespace esphome
       /// Get swing setting
       uint8_t swing_auto_();
 
+      /// Handle a new room temperature reading for iFeel.
+      void on_ifeel_temperature_(float temperature);
+      /// Send the latest room temperature reading as an iFeel report.
+      void transmit_ifeel_();
+
+      /// Copy the fields set in `call` to the entity.
+      void apply_call_(const climate::ClimateCall &call);
+
+#ifdef USE_GREEIR_FAST_BOOT
+      /// Send and clear the frame stored by send_on_wake(), if any.
+      void transmit_wake_frame_();
+      /// Read the frame stored for this entity. Returns false if there is none.
+      bool load_wake_frame_(uint32_t key, uint64_t &frame);
+      /// Store `frame` for the entity `key`.
+      void save_wake_frame_(uint32_t key, uint64_t frame);
+      /// Drop the frame stored for the entity `key`.
+      void clear_wake_frame_(uint32_t key);
+#endif
+
+      /// Start tracking an onboard timer of `minutes`, or stop tracking it for 0.
+      void track_timer_(uint32_t minutes);
+      /// The onboard timer fired: the unit toggled power by itself.
+      void on_timer_expired_();
+
+      /// Record `frame` as what the unit was last told, and schedule saving it.
+      void set_last_sent_state_(GreeFrame frame);
+      /// Take on the state of a frame the group leader just sent, as if this entity had sent it.
+      void apply_group_frame_(GreeFrame frame);
+      /// Drop copies of the last sent frame received before `echo_start` + `echo_window` ms.
+      void set_echo_window_(uint32_t echo_start, uint32_t echo_window)
+      {
+        this->echo_start_ = echo_start;
+        this->echo_window_ = echo_window;
+      }
+
+      /// Refine the calibration from a capture that decoded to `frame` with a valid checksum.
+      void learn_calibration_(const remote_base::RawTimings &raw, GreeFrame frame, GreeTolerance tolerance);
+
+      /// Count one occurrence of `diagnostic`.
+      void count_(GreeDiagnostic diagnostic) { this->diagnostic_counts_[static_cast<size_t>(diagnostic)]++; }
+      /// Publish the configured diagnostic sensors, then start a new timing period.
+      void publish_diagnostics_();
+
       /// Parse received IR data into climate state
-      bool parse_state_frame_(const uint8_t frame[]);
+      bool parse_state_frame_(GreeFrame frame);
+
+      /// Restore a model detected in a previous boot. Returns false if there is none.
+      bool restore_detected_model_();
+      /// Use `model` from now on and remember it across reboots.
+      void lock_detected_model_(GreeIRModel model);
 
       GreeIRModel model_{GreeIRModel::GENERIC};
       bool wifi_function_{false};
       bool check_checksum_{false};
       bool set_modes_{false};
       int8_t repeat_{1};
-      int32_t last_transmit_time_{};
+      uint32_t echo_start_{0};
+      uint32_t echo_window_{0};
+      uint32_t coalesce_window_{0};
+      bool transmit_pending_{false};
+      uint32_t keepalive_interval_{0};
+      GreeFrame last_sent_state_;
+      bool has_last_sent_state_{false};
+      ESPPreferenceObject model_pref_;
+      uint32_t dedup_window_{0};
+      GreeFrame last_received_state_;
+      bool has_last_received_state_{false};
+      uint32_t last_received_time_{0};
+      uint32_t duplicate_frames_{0};
+      bool async_transmit_{false};
+      GreeFrame burst_frame_;
+      uint8_t burst_remaining_{0};
+      CallbackManager<void()> transmit_complete_callback_;
+      sensor::Sensor *diagnostic_sensors_[static_cast<size_t>(GreeDiagnostic::COUNT)]{};
+      uint32_t diagnostic_counts_[static_cast<size_t>(GreeDiagnostic::AIRTIME)]{};
+      uint64_t airtime_us_{0};
+      GreeTimeStat decode_time_;
+      GreeTimeStat encode_time_;
+      uint32_t diagnostics_interval_{60000};
+      /// millis() at which the unit's timer fires, while `timer_running_`
+      uint32_t timer_expiry_{0};
+      bool timer_running_{false};
+      /// Whether the unit was on when the timer was set, i.e. whether it is an off timer
+      bool timer_power_{false};
+      /// Mode the unit powers on in when an on timer fires
+      climate::ClimateMode resume_mode_{climate::CLIMATE_MODE_HEAT_COOL};
+#ifdef USE_GREEIR_FAST_BOOT
+      bool sent_wake_frame_{false};
+#ifndef USE_ESP32
+      /// RTC slot of the stored frame, made in setup() and reused by every load and save
+      ESPPreferenceObject wake_pref_;
+#endif
+#endif
+      bool restore_last_sent_{true};
+      ESPPreferenceObject last_sent_pref_;
+      uint64_t saved_last_sent_{0};
+      std::vector<GreeIRClimate *> group_members_;
+      std::unique_ptr<GreeCaptureRecorder> recorder_;
+      bool record_rejected_{false};
+      bool calibrate_{false};
+      GreeCalibration calibration_;
+      GreeCalibration saved_calibration_;
+      ESPPreferenceObject calibration_pref_;
+      bool ifeel_{false};
+      float ifeel_delta_{0.5f};
+      uint32_t ifeel_min_interval_{0};
+      uint32_t ifeel_max_interval_{0};
+      float ifeel_temperature_{NAN};
+      float ifeel_reported_temperature_{NAN};
+      uint32_t ifeel_reported_time_{0};
+    };
+
+    /// GreeIRClimate with the codec of a single model compiled in.
+    /// climate.py instantiates this for the configured `model`, so other variants never reach the binary.
+    template <GreeIRModel Model>
+    class GreeIRModelClimate : public GreeIRClimate
+    {
+    public:
+      GreeIRModelClimate() { this->model_ = Model; }
+
+    protected:
+      void encode_(GreeFrame frame, GreePulseSink &sink, uint8_t repeat) override
+      {
+        GreeCodec<Model>::encode(frame, sink, repeat);
+      }
+
+      void encode_ifeel_(uint8_t temperature, GreePulseSink &sink) override
+      {
+        GreeCodec<Model>::encode_ifeel(temperature, sink);
+      }
+
+      bool matches_(const int32_t *data, size_t size, GreeTolerance tolerance,
+                    GreeCalibration calibration) const override
+      {
+        return GreeCodec<Model>::matches(data, size, tolerance, calibration);
+      }
+
+      GreeDecodeStage decode_(GreePulseSource &source, GreeFrame &frame) override
+      {
+        return GreeCodec<Model>::decode_repeated(source, frame);
+      }
+    };
+
+    /// GreeIRClimate for `model: auto`. Until a frame has been received it decodes with every
+    /// variant's codec and sends with the generic one; the first frame with a valid checksum
+    /// locks the model, after which only that codec is used.
+    template <>
+    class GreeIRModelClimate<GreeIRModel::AUTO> : public GreeIRClimate
+    {
+    public:
+      void setup() override
+      {
+        this->locked_ = this->restore_detected_model_();
+        GreeIRClimate::setup();
+      }
+
+    protected:
+      void encode_(GreeFrame frame, GreePulseSink &sink, uint8_t repeat) override
+      {
+        gree_with_codec(this->model_, [&](auto codec) { decltype(codec)::encode(frame, sink, repeat); });
+      }
+
+      void encode_ifeel_(uint8_t temperature, GreePulseSink &sink) override
+      {
+        gree_with_codec(this->model_, [&](auto codec) { decltype(codec)::encode_ifeel(temperature, sink); });
+      }
+
+      bool matches_(const int32_t *data, size_t size, GreeTolerance tolerance,
+                    GreeCalibration calibration) const override
+      {
+        GreeIRModel model;
+        if (this->locked_)
+          return gree_with_codec(this->model_,
+                                 [&](auto codec) { return decltype(codec)::matches(data, size, tolerance, calibration); });
+        return gree_classify(data, size, model, tolerance, calibration);
+      }
+
+      GreeDecodeStage decode_(GreePulseSource &source, GreeFrame &frame) override
+      {
+        if (this->locked_)
+          return gree_with_codec(this->model_, [&](auto codec) { return decltype(codec)::decode_repeated(source, frame); });
+
+        GreeIRModel model;
+        if (!gree_classify(source.get_pointer(), source.remaining(), model, source.get_tolerance(),
+                           source.get_calibration()))
+          return GreeDecodeStage::HEADER;
+        GreeDecodeStage stage = gree_with_codec(model, [&](auto codec) { return decltype(codec)::decode_repeated(source, frame); });
+        if (stage == GreeDecodeStage::OK && frame.is_checksum_valid())
+        {
+          if (model == GreeIRModel::YAW1F && !frame.get(GreeFrame::MODEL_A))
+            model = GreeIRModel::YBOFB;
+          this->lock_detected_model_(model);
+          this->locked_ = true;
+        }
+        return stage;
+      }
+
+      bool locked_{false};
     };
 
   } // namespace gree
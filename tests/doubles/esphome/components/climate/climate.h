@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstdint>
+#include <set>
+
+#include "esphome/core/helpers.h"
+
+namespace esphome
+{
+  namespace climate
+  {
+
+    enum ClimateMode : uint8_t
+    {
+      CLIMATE_MODE_OFF = 0,
+      CLIMATE_MODE_HEAT_COOL = 1,
+      CLIMATE_MODE_COOL = 2,
+      CLIMATE_MODE_HEAT = 3,
+      CLIMATE_MODE_FAN_ONLY = 4,
+      CLIMATE_MODE_DRY = 5,
+      CLIMATE_MODE_AUTO = 6,
+    };
+
+    enum ClimateFanMode : uint8_t
+    {
+      CLIMATE_FAN_ON = 0,
+      CLIMATE_FAN_OFF = 1,
+      CLIMATE_FAN_AUTO = 2,
+      CLIMATE_FAN_LOW = 3,
+      CLIMATE_FAN_MEDIUM = 4,
+      CLIMATE_FAN_HIGH = 5,
+      CLIMATE_FAN_MIDDLE = 6,
+      CLIMATE_FAN_FOCUS = 7,
+      CLIMATE_FAN_DIFFUSE = 8,
+      CLIMATE_FAN_QUIET = 9,
+    };
+
+    enum ClimateSwingMode : uint8_t
+    {
+      CLIMATE_SWING_OFF = 0,
+      CLIMATE_SWING_BOTH = 1,
+      CLIMATE_SWING_VERTICAL = 2,
+      CLIMATE_SWING_HORIZONTAL = 3,
+    };
+
+    enum ClimatePreset : uint8_t
+    {
+      CLIMATE_PRESET_NONE = 0,
+      CLIMATE_PRESET_HOME = 1,
+      CLIMATE_PRESET_AWAY = 2,
+      CLIMATE_PRESET_BOOST = 3,
+      CLIMATE_PRESET_COMFORT = 4,
+      CLIMATE_PRESET_ECO = 5,
+      CLIMATE_PRESET_SLEEP = 6,
+      CLIMATE_PRESET_ACTIVITY = 7,
+    };
+
+    class ClimateTraits
+    {
+    public:
+      void set_supported_modes(std::set<ClimateMode> modes) { this->supported_modes_ = std::move(modes); }
+      const std::set<ClimateMode> &get_supported_modes() const { return this->supported_modes_; }
+
+    protected:
+      std::set<ClimateMode> supported_modes_;
+    };
+
+    class Climate;
+
+    class ClimateCall
+    {
+    public:
+      explicit ClimateCall(Climate *parent) : parent_(parent) {}
+
+      ClimateCall &set_mode(ClimateMode mode)
+      {
+        this->mode_ = mode;
+        return *this;
+      }
+      ClimateCall &set_target_temperature(float target_temperature)
+      {
+        this->target_temperature_ = target_temperature;
+        return *this;
+      }
+      ClimateCall &set_fan_mode(ClimateFanMode fan_mode)
+      {
+        this->fan_mode_ = fan_mode;
+        return *this;
+      }
+      ClimateCall &set_swing_mode(ClimateSwingMode swing_mode)
+      {
+        this->swing_mode_ = swing_mode;
+        return *this;
+      }
+      ClimateCall &set_preset(ClimatePreset preset)
+      {
+        this->preset_ = preset;
+        return *this;
+      }
+      void perform();
+
+      const optional<ClimateMode> &get_mode() const { return this->mode_; }
+      const optional<float> &get_target_temperature() const { return this->target_temperature_; }
+      const optional<ClimateFanMode> &get_fan_mode() const { return this->fan_mode_; }
+      const optional<ClimateSwingMode> &get_swing_mode() const { return this->swing_mode_; }
+      const optional<ClimatePreset> &get_preset() const { return this->preset_; }
+
+    protected:
+      Climate *parent_;
+      optional<ClimateMode> mode_;
+      optional<float> target_temperature_;
+      optional<ClimateFanMode> fan_mode_;
+      optional<ClimateSwingMode> swing_mode_;
+      optional<ClimatePreset> preset_;
+    };
+
+    class Climate
+    {
+    public:
+      virtual ~Climate() = default;
+
+      ClimateCall make_call() { return ClimateCall(this); }
+      void publish_state() { this->publish_count++; }
+      uint32_t get_object_id_hash() { return this->object_id_hash; }
+
+      ClimateMode mode{CLIMATE_MODE_OFF};
+      float current_temperature{0.0f};
+      float target_temperature{0.0f};
+      optional<ClimateFanMode> fan_mode;
+      ClimateSwingMode swing_mode{CLIMATE_SWING_OFF};
+      optional<ClimatePreset> preset;
+
+      /// Test hooks: the key preferences are stored under, and how often state was published.
+      uint32_t object_id_hash{0x12345678};
+      size_t publish_count{0};
+
+    protected:
+      friend ClimateCall;
+
+      virtual void control(const ClimateCall &call) = 0;
+      virtual ClimateTraits traits() = 0;
+    };
+
+    inline void ClimateCall::perform() { this->parent_->control(*this); }
+
+  } // namespace climate
+} // namespace esphome
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <set>
+
+#include "esphome/core/component.h"
+#include "esphome/components/climate/climate.h"
+#include "esphome/components/remote_base/remote_base.h"
+#include "esphome/components/sensor/sensor.h"
+
+namespace esphome
+{
+  namespace climate_ir
+  {
+
+    class ClimateIR : public Component, public climate::Climate, public remote_base::RemoteReceiverListener
+    {
+    public:
+      ClimateIR(float minimum_temperature, float maximum_temperature, float /* temperature_step */ = 1.0f,
+                bool /* supports_dry */ = false, bool /* supports_fan_only */ = false,
+                std::set<climate::ClimateFanMode> /* fan_modes */ = {},
+                std::set<climate::ClimateSwingMode> /* swing_modes */ = {},
+                std::set<climate::ClimatePreset> /* presets */ = {})
+          : minimum_temperature_(minimum_temperature), maximum_temperature_(maximum_temperature) {}
+
+      void setup() override
+      {
+        // A fresh device restores nothing: off, at the lowest target
+        this->mode = climate::CLIMATE_MODE_OFF;
+        this->target_temperature = this->minimum_temperature_;
+      }
+
+      void set_transmitter(remote_base::RemoteTransmitterBase *transmitter) { this->transmitter_ = transmitter; }
+      void set_sensor(sensor::Sensor *sensor) { this->sensor_ = sensor; }
+
+    protected:
+      climate::ClimateTraits traits() override { return climate::ClimateTraits(); }
+      virtual void transmit_state() = 0;
+
+      float minimum_temperature_;
+      float maximum_temperature_;
+      remote_base::RemoteTransmitterBase *transmitter_{nullptr};
+      sensor::Sensor *sensor_{nullptr};
+    };
+
+  } // namespace climate_ir
+} // namespace esphome
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "esphome/core/component.h"
+
+namespace esphome
+{
+  namespace remote_base
+  {
+
+    using RawTimings = std::vector<int32_t>;
+
+    enum ToleranceMode : uint8_t
+    {
+      TOLERANCE_MODE_PERCENTAGE = 0,
+      TOLERANCE_MODE_TIME = 1,
+    };
+
+    class RemoteTransmitData
+    {
+    public:
+      void mark(uint32_t length) { this->data_.push_back(length); }
+      void space(uint32_t length) { this->data_.push_back(-static_cast<int32_t>(length)); }
+      void item(uint32_t mark, uint32_t space)
+      {
+        this->mark(mark);
+        this->space(space);
+      }
+      void reserve(uint32_t len) { this->data_.reserve(len); }
+      void set_carrier_frequency(uint32_t carrier_frequency) { this->carrier_frequency_ = carrier_frequency; }
+      uint32_t get_carrier_frequency() const { return this->carrier_frequency_; }
+      const RawTimings &get_data() const { return this->data_; }
+      void reset()
+      {
+        this->data_.clear();
+        this->carrier_frequency_ = 0;
+      }
+
+    protected:
+      RawTimings data_;
+      uint32_t carrier_frequency_{0};
+    };
+
+    class RemoteReceiveData
+    {
+    public:
+      RemoteReceiveData(const RawTimings &data, uint32_t tolerance, ToleranceMode tolerance_mode)
+          : data_(data), tolerance_(tolerance), tolerance_mode_(tolerance_mode) {}
+
+      const RawTimings &get_raw_data() const { return this->data_; }
+      uint32_t get_tolerance() { return this->tolerance_; }
+      ToleranceMode get_tolerance_mode() { return this->tolerance_mode_; }
+
+    protected:
+      const RawTimings &data_;
+      uint32_t tolerance_;
+      ToleranceMode tolerance_mode_;
+    };
+
+    class RemoteTransmitterBase
+    {
+    public:
+      virtual ~RemoteTransmitterBase() = default;
+
+      class TransmitCall
+      {
+      public:
+        explicit TransmitCall(RemoteTransmitterBase *parent) : parent_(parent) {}
+        RemoteTransmitData *get_data() { return &this->parent_->temp_; }
+        void set_send_times(uint32_t send_times) { this->send_times_ = send_times; }
+        void set_send_wait(uint32_t send_wait) { this->send_wait_ = send_wait; }
+        void perform() { this->parent_->send_internal(this->send_times_, this->send_wait_); }
+
+      protected:
+        RemoteTransmitterBase *parent_;
+        uint32_t send_times_{1};
+        uint32_t send_wait_{0};
+      };
+
+      TransmitCall transmit()
+      {
+        this->temp_.reset();
+        return TransmitCall(this);
+      }
+
+    protected:
+      virtual void send_internal(uint32_t send_times, uint32_t send_wait) = 0;
+
+      RemoteTransmitData temp_;
+    };
+
+    class RemoteReceiverListener
+    {
+    public:
+      virtual ~RemoteReceiverListener() = default;
+      virtual bool on_receive(RemoteReceiveData data) = 0;
+    };
+
+  } // namespace remote_base
+} // namespace esphome
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cmath>
+#include <functional>
+
+#include "esphome/core/helpers.h"
+
+namespace esphome
+{
+  namespace sensor
+  {
+
+    class Sensor
+    {
+    public:
+      void publish_state(float state)
+      {
+        this->state = state;
+        this->callback_.call(state);
+      }
+
+      void add_on_state_callback(std::function<void(float)> &&callback) { this->callback_.add(std::move(callback)); }
+      bool has_state() const { return !std::isnan(this->state); }
+
+      float state{NAN};
+
+    protected:
+      CallbackManager<void(float)> callback_;
+    };
+
+  } // namespace sensor
+} // namespace esphome
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <functional>
+
+#include "esphome/core/helpers.h"
+
+namespace esphome
+{
+
+  template <typename T, typename... X>
+  class TemplatableValue
+  {
+  public:
+    TemplatableValue() {}
+    TemplatableValue(T value) : value_(value) {}
+
+    T value(X... x) { return this->f_ ? this->f_(x...) : this->value_; }
+    bool has_value() const { return true; }
+
+  protected:
+    T value_{};
+    std::function<T(X...)> f_;
+  };
+
+#define TEMPLATABLE_VALUE(type, name)             \
+protected:                                        \
+  TemplatableValue<type, Ts...> name##_{};        \
+                                                  \
+public:                                           \
+  template <typename V>                           \
+  void set_##name(V name) { this->name##_ = name; }
+
+  template <typename... Ts>
+  class Action
+  {
+  public:
+    virtual ~Action() = default;
+    virtual void play(Ts... x) = 0;
+  };
+
+} // namespace esphome
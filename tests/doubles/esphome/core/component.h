@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/preferences.h"
+
+namespace esphome
+{
+
+  class Component
+  {
+  public:
+    virtual ~Component();
+
+    virtual void setup() {}
+    virtual void loop() {}
+    virtual void dump_config() {}
+    virtual float get_setup_priority() const { return 0.0f; }
+
+  protected:
+    void set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f);
+    bool cancel_timeout(const std::string &name);
+    void set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f);
+    bool cancel_interval(const std::string &name);
+  };
+
+  namespace sim
+  {
+    /// Run the scheduled callbacks that are due, in the order they fall due. Returns the
+    /// longest time (us) a single one of them ran for.
+    uint64_t run_scheduler();
+    /// Milliseconds until the next scheduled callback, or UINT32_MAX if there is none.
+    uint32_t next_scheduled();
+    /// Forget every scheduled callback.
+    void clear_scheduler();
+  } // namespace sim
+
+} // namespace esphome
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome
+{
+
+  /// Simulated clock: only advances when a test or a double moves it.
+  namespace sim
+  {
+    extern uint64_t now_us;
+
+    inline void advance_us(uint64_t us) { now_us += us; }
+    inline void advance_ms(uint32_t ms) { now_us += uint64_t(ms) * 1000; }
+  } // namespace sim
+
+  inline uint32_t millis() { return static_cast<uint32_t>(sim::now_us / 1000); }
+  inline uint32_t micros() { return static_cast<uint32_t>(sim::now_us); }
+  inline void delay(uint32_t ms) { sim::advance_ms(ms); }
+  inline void delayMicroseconds(uint32_t us) { sim::advance_us(us); }
+
+} // namespace esphome
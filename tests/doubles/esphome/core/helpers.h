@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace esphome
+{
+
+  template <typename T>
+  using optional = std::optional<T>;
+
+  template <typename T>
+  class Parented
+  {
+  public:
+    Parented() {}
+    Parented(T *parent) : parent_(parent) {}
+
+    T *get_parent() const { return this->parent_; }
+    void set_parent(T *parent) { this->parent_ = parent; }
+
+  protected:
+    T *parent_{nullptr};
+  };
+
+  template <typename... Ts>
+  class CallbackManager;
+
+  template <typename... Ts>
+  class CallbackManager<void(Ts...)>
+  {
+  public:
+    void add(std::function<void(Ts...)> &&callback) { this->callbacks_.push_back(std::move(callback)); }
+
+    void call(Ts... args)
+    {
+      for (auto &callback : this->callbacks_)
+        callback(args...);
+    }
+
+  protected:
+    std::vector<std::function<void(Ts...)>> callbacks_;
+  };
+
+} // namespace esphome
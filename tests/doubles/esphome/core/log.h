@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdio>
+
+// Arguments are type-checked but nothing is printed
+#define ESP_LOG_DISCARD(tag, ...) \
+  do                              \
+  {                               \
+    if (0)                        \
+      std::printf(__VA_ARGS__);   \
+    (void) (tag);                 \
+  } while (0)
+
+#define ESP_LOGE ESP_LOG_DISCARD
+#define ESP_LOGW ESP_LOG_DISCARD
+#define ESP_LOGI ESP_LOG_DISCARD
+#define ESP_LOGD ESP_LOG_DISCARD
+#define ESP_LOGV ESP_LOG_DISCARD
+#define ESP_LOGVV ESP_LOG_DISCARD
+#define ESP_LOGCONFIG ESP_LOG_DISCARD
+#define LOG_SENSOR(prefix, type, obj) (void) (obj)
+#define YESNO(b) ((b) ? "YES" : "NO")
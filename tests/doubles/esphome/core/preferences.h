@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace esphome
+{
+
+  /// In-memory preference storage. Every make_preference() call takes a new slot, as the
+  /// ESP8266 RTC backend does, so tests can see how many a component uses.
+  class ESPPreferenceObject
+  {
+  public:
+    ESPPreferenceObject() {}
+    explicit ESPPreferenceObject(std::vector<uint8_t> *data) : data_(data) {}
+
+    template <typename T>
+    bool save(const T *src)
+    {
+      if (this->data_ == nullptr)
+        return false;
+      this->data_->assign(reinterpret_cast<const uint8_t *>(src), reinterpret_cast<const uint8_t *>(src) + sizeof(T));
+      return true;
+    }
+
+    template <typename T>
+    bool load(T *dest)
+    {
+      if (this->data_ == nullptr || this->data_->size() != sizeof(T))
+        return false;
+      std::memcpy(dest, this->data_->data(), sizeof(T));
+      return true;
+    }
+
+  protected:
+    std::vector<uint8_t> *data_{nullptr};
+  };
+
+  class ESPPreferences
+  {
+  public:
+    template <typename T>
+    ESPPreferenceObject make_preference(uint32_t type, bool in_flash)
+    {
+      this->slots_made++;
+      return ESPPreferenceObject(&(in_flash ? this->flash : this->rtc)[type]);
+    }
+
+    template <typename T>
+    ESPPreferenceObject make_preference(uint32_t type)
+    {
+      return this->make_preference<T>(type, true);
+    }
+
+    bool sync() { return true; }
+
+    /// Stored values by key; they survive a simulated reboot.
+    std::map<uint32_t, std::vector<uint8_t>> flash;
+    std::map<uint32_t, std::vector<uint8_t>> rtc;
+    size_t slots_made{0};
+  };
+
+  extern ESPPreferences *global_preferences;
+
+} // namespace esphome
@@ -0,0 +1,126 @@
+// Definitions behind the ESPHome test doubles: the simulated clock, the scheduler
+// and the preference store.
+
+#include <algorithm>
+#include <list>
+
+#include "esphome/core/component.h"
+#include "esphome/core/preferences.h"
+
+namespace esphome
+{
+
+  namespace sim
+  {
+    uint64_t now_us = 0;
+  } // namespace sim
+
+  static ESPPreferences preferences;
+  ESPPreferences *global_preferences = &preferences;
+
+  namespace
+  {
+
+    struct ScheduledItem
+    {
+      Component *component;
+      std::string name;
+      bool interval;
+      uint64_t next_us;
+      uint32_t period_ms;
+      std::function<void()> f;
+      bool removed;
+    };
+
+    std::list<ScheduledItem> items;
+
+    bool cancel(Component *component, const std::string &name, bool interval)
+    {
+      bool found = false;
+      for (auto &item : items)
+      {
+        if (!item.removed && item.component == component && item.interval == interval && item.name == name)
+        {
+          item.removed = true;
+          found = true;
+        }
+      }
+      return found;
+    }
+
+    void schedule(Component *component, const std::string &name, bool interval, uint32_t ms, std::function<void()> &&f)
+    {
+      cancel(component, name, interval);
+      items.push_back(ScheduledItem{component, name, interval, sim::now_us + uint64_t(ms) * 1000, ms, std::move(f), false});
+    }
+
+  } // namespace
+
+  Component::~Component()
+  {
+    for (auto &item : items)
+    {
+      if (item.component == this)
+        item.removed = true;
+    }
+  }
+
+  void Component::set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f)
+  {
+    schedule(this, name, false, timeout, std::move(f));
+  }
+
+  bool Component::cancel_timeout(const std::string &name) { return cancel(this, name, false); }
+
+  void Component::set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f)
+  {
+    schedule(this, name, true, interval, std::move(f));
+  }
+
+  bool Component::cancel_interval(const std::string &name) { return cancel(this, name, true); }
+
+  namespace sim
+  {
+
+    uint64_t run_scheduler()
+    {
+      uint64_t longest = 0;
+      for (;;)
+      {
+        items.remove_if([](const ScheduledItem &item) { return item.removed; });
+        auto due = std::min_element(items.begin(), items.end(), [](const ScheduledItem &a, const ScheduledItem &b) {
+          return a.next_us < b.next_us;
+        });
+        if (due == items.end() || due->next_us > now_us)
+          return longest;
+
+        // The callback may reschedule or cancel items, including itself
+        std::function<void()> f = due->f;
+        if (due->interval)
+          due->next_us += uint64_t(due->period_ms) * 1000;
+        else
+          due->removed = true;
+        const uint64_t start = now_us;
+        f();
+        longest = std::max(longest, now_us - start);
+      }
+    }
+
+    uint32_t next_scheduled()
+    {
+      uint64_t next = UINT64_MAX;
+      for (const auto &item : items)
+      {
+        if (!item.removed)
+          next = std::min(next, item.next_us);
+      }
+      if (next == UINT64_MAX)
+        return UINT32_MAX;
+      return next <= now_us ? 0 : static_cast<uint32_t>((next - now_us + 999) / 1000);
+    }
+
+    void clear_scheduler() { items.clear(); }
+
+  } // namespace sim
+
+} // namespace esphome
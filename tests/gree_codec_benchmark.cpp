@@ -0,0 +1,127 @@
+// ns/frame of the codec's hot paths for every model variant.
+//   ./gree_codec_benchmark --benchmark_filter=GENERIC
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include "gree_codec.h"
+
+using namespace esphome::greeir;
+
+namespace
+{
+
+  /// Sink that keeps the pulse train, like the transmit buffer on the device.
+  class VectorSink : public GreePulseSink
+  {
+  public:
+    void reserve(size_t count) override { this->timings.reserve(count); }
+    void write(const int32_t *timings, size_t count) override { this->timings.insert(this->timings.end(), timings, timings + count); }
+
+    std::vector<int32_t> timings;
+  };
+
+  /// Frames with valid checksums, so decoding takes the full path.
+  std::vector<GreeFrame> make_frames(size_t count)
+  {
+    std::mt19937_64 rng(1);
+    std::vector<GreeFrame> frames;
+    for (size_t i = 0; i < count; i++)
+      frames.push_back(GreeFrame(rng()).update_checksum());
+    return frames;
+  }
+
+  template <GreeIRModel Model>
+  void BM_EncodeFrame(benchmark::State &state)
+  {
+    const auto frames = make_frames(256);
+    GreeFrameTimings timings;
+    size_t i = 0;
+    for (auto _ : state)
+    {
+      GreeCodec<Model>::encode_frame(frames[i++ & 255], timings);
+      benchmark::DoNotOptimize(timings.data());
+      benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  template <GreeIRModel Model>
+  void BM_Decode(benchmark::State &state)
+  {
+    const auto frames = make_frames(256);
+    std::vector<GreeFrameTimings> captures(frames.size());
+    for (size_t i = 0; i < frames.size(); i++)
+      GreeCodec<Model>::encode_frame(frames[i], captures[i]);
+    size_t i = 0;
+    for (auto _ : state)
+    {
+      const auto &capture = captures[i++ & 255];
+      GreePulseSource source(capture.data(), capture.size());
+      GreeFrame frame;
+      benchmark::DoNotOptimize(GreeCodec<Model>::decode(source, frame));
+      benchmark::DoNotOptimize(frame);
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  /// Decode of a capture holding `range(0)` repeats, combined by majority vote.
+  template <GreeIRModel Model>
+  void BM_DecodeRepeated(benchmark::State &state)
+  {
+    const auto frames = make_frames(64);
+    std::vector<VectorSink> captures(frames.size());
+    for (size_t i = 0; i < frames.size(); i++)
+      GreeCodec<Model>::encode(frames[i], captures[i], state.range(0));
+    size_t i = 0;
+    for (auto _ : state)
+    {
+      const auto &capture = captures[i++ & 63].timings;
+      GreePulseSource source(capture.data(), capture.size());
+      GreeFrame frame;
+      benchmark::DoNotOptimize(GreeCodec<Model>::decode_repeated(source, frame));
+      benchmark::DoNotOptimize(frame);
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  /// Full pulse train of `range(0)` repeats into a growing buffer, as transmit_state() does.
+  template <GreeIRModel Model>
+  void BM_PulseTrain(benchmark::State &state)
+  {
+    const auto frames = make_frames(256);
+    size_t i = 0;
+    for (auto _ : state)
+    {
+      VectorSink sink;
+      GreeCodec<Model>::encode(frames[i++ & 255], sink, state.range(0));
+      benchmark::DoNotOptimize(sink.timings.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+
+  void BM_Checksum(benchmark::State &state)
+  {
+    const auto frames = make_frames(256);
+    size_t i = 0;
+    for (auto _ : state)
+      benchmark::DoNotOptimize(frames[i++ & 255].calc_checksum());
+    state.SetItemsProcessed(state.iterations());
+  }
+
+} // namespace
+
+#define GREE_MODEL_BENCHMARKS(model)                                                       \
+  BENCHMARK_TEMPLATE(BM_EncodeFrame, GreeIRModel::model)->Name("EncodeFrame/" #model);     \
+  BENCHMARK_TEMPLATE(BM_Decode, GreeIRModel::model)->Name("Decode/" #model);               \
+  BENCHMARK_TEMPLATE(BM_DecodeRepeated, GreeIRModel::model)->Name("DecodeRepeated/" #model)->Arg(1)->Arg(3); \
+  BENCHMARK_TEMPLATE(BM_PulseTrain, GreeIRModel::model)->Name("PulseTrain/" #model)->Arg(1)->Arg(4)
+
+GREE_MODEL_BENCHMARKS(GENERIC);
+GREE_MODEL_BENCHMARKS(YAW1F);
+GREE_MODEL_BENCHMARKS(YBOFB);
+GREE_MODEL_BENCHMARKS(YAC1FB9);
+GREE_MODEL_BENCHMARKS(YT1F);
+BENCHMARK(BM_Checksum)->Name("Checksum");
@@ -0,0 +1,480 @@
+// Round trips of the hardware-free codec: the whole protocol state space through
+// encode_state/decode_state, and every model's pulse codec through a mock transmitter
+// and receiver at the repeat counts the component allows, whole or a timing at a time.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "gree_codec.h"
+#include "gree_stream_decoder.h"
+
+using namespace esphome::greeir;
+
+namespace
+{
+
+  /// Mock transmitter: keeps the pulse train as RemoteTransmitData would.
+  class VectorSink : public GreePulseSink
+  {
+  public:
+    void reserve(size_t count) override { this->timings.reserve(count); }
+    void write(const int32_t *timings, size_t count) override { this->timings.insert(this->timings.end(), timings, timings + count); }
+
+    std::vector<int32_t> timings;
+  };
+
+  /// Mock receiver: what remote_receiver hands to listeners for a transmitted train. The
+  /// trailing space is never captured, as the idle timeout ends the capture on it, and
+  /// timings beyond the buffer are lost.
+  std::vector<int32_t> receive(const std::vector<int32_t> &transmitted, size_t buffer = 8 * GREE_FRAME_ITEMS)
+  {
+    const size_t size = std::min(transmitted.size() - 1, buffer);
+    return std::vector<int32_t>(transmitted.begin(), transmitted.begin() + size);
+  }
+
+  bool operator==(const GreeState &a, const GreeState &b)
+  {
+    return a.power == b.power && a.mode == b.mode && a.fan == b.fan && a.temperature == b.temperature &&
+           a.swing_v == b.swing_v && a.swing_h == b.swing_h && a.swing_auto == b.swing_auto && a.sleep == b.sleep &&
+           a.model_a == b.model_a && a.wifi == b.wifi && a.light == b.light && a.ifeel == b.ifeel && a.timer == b.timer;
+  }
+
+  /// Call `f` with every state a frame can carry: each field over its full width and the
+  /// temperature over its range. The timer, whose bits no other field shares, takes one
+  /// value per state and cycles through every half hour up to its maximum, which keeps
+  /// the run short without leaving any timer value out.
+  template <typename F>
+  void for_each_state(F &&f)
+  {
+    GreeState state;
+    uint16_t timer = 0;
+    for (uint8_t mode = 0; mode < 8; mode++)
+      for (uint8_t fan = 0; fan < 4; fan++)
+        for (uint8_t temperature = GREE_TEMP_MIN; temperature <= GREE_TEMP_MAX; temperature++)
+          for (uint8_t swing_v = 0; swing_v < 16; swing_v++)
+            for (uint8_t swing_h = 0; swing_h < 8; swing_h++)
+              for (uint8_t flags = 0; flags < 128; flags++)
+              {
+                state.mode = mode;
+                state.fan = fan;
+                state.temperature = temperature;
+                state.swing_v = swing_v;
+                state.swing_h = swing_h;
+                state.power = flags & 1;
+                state.swing_auto = (flags >> 1) & 1;
+                state.sleep = (flags >> 2) & 1;
+                state.model_a = (flags >> 3) & 1;
+                state.wifi = (flags >> 4) & 1;
+                state.light = (flags >> 5) & 1;
+                state.ifeel = (flags >> 6) & 1;
+                state.timer = timer;
+                f(state);
+                timer = timer < GREE_TIMER_MAX ? timer + 30 : 0;
+              }
+  }
+
+  /// The states the climate entity can ask for, which is what goes on the air.
+  template <typename F>
+  void for_each_climate_state(F &&f)
+  {
+    GreeState state;
+    for (uint8_t power = 0; power < 2; power++)
+      for (uint8_t mode = GREE_MODE_AUTO; mode <= GREE_MODE_HEAT; mode++)
+        for (uint8_t fan = 0; fan < 4; fan++)
+          for (uint8_t temperature = GREE_TEMP_MIN; temperature <= GREE_TEMP_MAX; temperature++)
+            for (uint8_t swing = 0; swing < 4; swing++)
+              for (uint8_t sleep = 0; sleep < 2; sleep++)
+              {
+                state.power = power;
+                state.mode = mode;
+                state.fan = fan;
+                state.temperature = temperature;
+                state.swing_auto = swing == 0 ? GREE_SWING_AUTO : GREE_SWING_MANUAL;
+                state.swing_v = swing & 1 ? GREE_VDIR_SWING : GREE_VDIR_MANUAL;
+                state.swing_h = swing & 2 ? GREE_HDIR_SWING : GREE_HDIR_MANUAL;
+                state.sleep = sleep;
+                f(state);
+              }
+  }
+
+  template <GreeIRModel Model>
+  struct ModelTag
+  {
+    static constexpr GreeIRModel MODEL = Model;
+  };
+
+  template <typename Tag>
+  class GreeCodecTest : public testing::Test
+  {
+  };
+
+  using Models = testing::Types<ModelTag<GreeIRModel::GENERIC>, ModelTag<GreeIRModel::YAW1F>, ModelTag<GreeIRModel::YBOFB>,
+                                ModelTag<GreeIRModel::YAC1FB9>, ModelTag<GreeIRModel::YT1F>>;
+  TYPED_TEST_SUITE(GreeCodecTest, Models);
+
+} // namespace
+
+TEST(GreeStateTest, StateSpaceIsBijective)
+{
+  // Checked without assertion macros in the loop, which would dominate its run time
+  size_t states = 0;
+  size_t failures = 0;
+  GreeFrame first_failure;
+  for_each_state([&](const GreeState &state) {
+    // decode_state() inverting encode_state() on every state makes the encoding injective,
+    // so each frame in its image stands for exactly one state
+    const GreeFrame frame = encode_state(state);
+    if (!frame.is_checksum_valid() || !(decode_state(frame) == state))
+    {
+      if (failures++ == 0)
+        first_failure = frame;
+    }
+    states++;
+  });
+  EXPECT_EQ(states, 8u * 4 * (GREE_TEMP_MAX - GREE_TEMP_MIN + 1) * 16 * 8 * 128);
+  EXPECT_EQ(failures, 0u) << "first failing frame " << std::hex << first_failure.raw();
+}
+
+TYPED_TEST(GreeCodecTest, EveryStateRoundTripsAtEveryRepeatCount)
+{
+  using Codec = GreeCodec<TypeParam::MODEL>;
+  size_t frames = 0;
+  const auto start = std::chrono::steady_clock::now();
+  // The range of the repeat option
+  for (uint8_t repeat = 1; repeat <= 100; repeat++)
+  {
+    for_each_climate_state([&](const GreeState &state) {
+      const GreeFrame frame = encode_state(state);
+      VectorSink transmitter;
+      Codec::encode(frame, transmitter, repeat);
+      ASSERT_EQ(transmitter.timings.size(), repeat * GREE_FRAME_ITEMS);
+
+      const std::vector<int32_t> capture = receive(transmitter.timings);
+      ASSERT_TRUE(Codec::matches(capture.data(), capture.size()));
+      GreePulseSource source(capture.data(), capture.size());
+      GreeFrame decoded;
+      ASSERT_EQ(Codec::decode_repeated(source, decoded), GreeDecodeStage::OK);
+      ASSERT_EQ(decoded.raw(), frame.raw());
+      ASSERT_TRUE(decode_state(decoded) == state);
+      frames++;
+    });
+  }
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::printf("%s: %zu captures, %.0f frames/s\n", gree_model_to_string(TypeParam::MODEL), frames, frames / seconds);
+  this->RecordProperty("frames_per_second", static_cast<int>(frames / seconds));
+}
+
+TYPED_TEST(GreeCodecTest, EncodingIsInjective)
+{
+  using Codec = GreeCodec<TypeParam::MODEL>;
+  std::mt19937_64 rng(1);
+  GreeFrameTimings a;
+  GreeFrameTimings b;
+  for (int i = 0; i < 10000; i++)
+  {
+    const GreeFrame frame(rng());
+    const GreeFrame flipped(frame.raw() ^ (1ULL << (rng() % 64)));
+    Codec::encode_frame(frame, a);
+    Codec::encode_frame(flipped, b);
+    ASSERT_NE(a, b);
+  }
+}
+
+TYPED_TEST(GreeCodecTest, VotesPastADamagedFirstRepeat)
+{
+  using Codec = GreeCodec<TypeParam::MODEL>;
+  GreeState state;
+  state.power = true;
+  state.temperature = 23;
+  const GreeFrame frame = encode_state(state);
+  VectorSink transmitter;
+  Codec::encode(frame, transmitter, 3);
+
+  for (size_t index : {size_t(0), size_t(1), size_t(2), size_t(3), GREE_MESSAGE_SPACE_INDEX, GREE_MESSAGE_SPACE_INDEX + 1})
+  {
+    std::vector<int32_t> capture = receive(transmitter.timings);
+    capture[index] = capture[index] > 0 ? 100 : -100;
+    ASSERT_TRUE(Codec::matches(capture.data(), capture.size())) << "damaged at " << index;
+    GreePulseSource source(capture.data(), capture.size());
+    GreeFrame decoded;
+    ASSERT_EQ(Codec::decode_repeated(source, decoded), GreeDecodeStage::OK);
+    EXPECT_EQ(decoded.raw(), frame.raw());
+
+    // A single damaged frame has nothing to vote with
+    capture.resize(GREE_FRAME_ITEMS - 1);
+    EXPECT_FALSE(Codec::matches(capture.data(), capture.size())) << "damaged at " << index;
+  }
+}
+
+TYPED_TEST(GreeCodecTest, HonoursTheReceiverTolerance)
+{
+  using Codec = GreeCodec<TypeParam::MODEL>;
+  using Timing = typename Codec::Timing;
+  const GreeFrame frame = encode_state(GreeState{});
+  VectorSink transmitter;
+  Codec::encode(frame, transmitter, 1);
+  std::vector<int32_t> capture = receive(transmitter.timings);
+  // Stretch every mark by 200 us: out of 25% of a bit mark, within a 250 us time tolerance
+  for (int32_t &timing : capture)
+  {
+    if (timing > 0)
+      timing += 200;
+  }
+  ASSERT_GT(200u, Timing::BIT_MARK / 4);
+
+  EXPECT_FALSE(Codec::matches(capture.data(), capture.size()));
+  const GreeTolerance time{0, 250};
+  ASSERT_TRUE(Codec::matches(capture.data(), capture.size(), time));
+  GreePulseSource source(capture.data(), capture.size(), time);
+  GreeFrame decoded;
+  ASSERT_EQ(Codec::decode_repeated(source, decoded), GreeDecodeStage::OK);
+  EXPECT_EQ(decoded.raw(), frame.raw());
+}
+
+TYPED_TEST(GreeCodecTest, AppliesTheLearnedCalibration)
+{
+  using Codec = GreeCodec<TypeParam::MODEL>;
+  using Timing = typename Codec::Timing;
+  const GreeFrame frame = encode_state(GreeState{});
+  VectorSink transmitter;
+  Codec::encode(frame, transmitter, 2);
+  const std::vector<int32_t> nominal = receive(transmitter.timings);
+  // A receiver that stretches marks by 180 us and shortens spaces by 150 us, with +-20 us of jitter
+  std::vector<int32_t> capture = nominal;
+  for (size_t i = 0; i < capture.size(); i++)
+    capture[i] += (capture[i] > 0 ? 180 : 150) + (i % 2 == i / 2 % 2 ? 20 : -20);
+  ASSERT_GT(180u, Timing::BIT_MARK / 4);
+  EXPECT_FALSE(Codec::matches(capture.data(), capture.size()));
+
+  GreeCalibration calibration;
+  ASSERT_TRUE(gree_measure_bias(capture.data(), nominal.data(), capture.size(), calibration, GreeTolerance{25, 250}));
+  EXPECT_NEAR(calibration.mark_bias, 180, 2);
+  EXPECT_NEAR(calibration.space_bias, -150, 2);
+  EXPECT_NEAR(calibration.jitter, 20, 2);
+
+  // The prefilter and the classifier see corrected timings, as the decoder does
+  const GreeTolerance learned = gree_learned_tolerance(calibration);
+  EXPECT_TRUE(Codec::matches(capture.data(), capture.size(), learned, calibration));
+  GreeIRModel model = GreeIRModel::AUTO;
+  EXPECT_TRUE(gree_classify(capture.data(), capture.size(), model, learned, calibration));
+  GreePulseSource source(capture.data(), capture.size(), learned);
+  source.set_calibration(calibration);
+  GreeFrame decoded;
+  ASSERT_EQ(Codec::decode_repeated(source, decoded), GreeDecodeStage::OK);
+  EXPECT_EQ(decoded.raw(), frame.raw());
+
+  // The learned windows are narrower than the receiver's 25% for the long timings
+  EXPECT_LT(learned.upper(Timing::HEADER_MARK), GreeTolerance{}.upper(Timing::HEADER_MARK));
+  EXPECT_GT(learned.lower(Timing::HEADER_MARK), GreeTolerance{}.lower(Timing::HEADER_MARK));
+}
+
+TYPED_TEST(GreeCodecTest, StreamDecoderFindsEveryRepeatPastNoise)
+{
+  using Codec = GreeCodec<TypeParam::MODEL>;
+  using Decoder = GreeStreamDecoder<typename Codec::Layout>;
+  std::mt19937_64 rng(1);
+  GreeFrameTimings timings;
+  for (int i = 0; i < 1000; i++)
+  {
+    const GreeFrame frame = GreeFrame(rng()).update_checksum();
+    Codec::encode_frame(frame, timings);
+    // Pulses of another remote, then 1-3 repeats, all with +-50 us of jitter
+    std::vector<int32_t> stream;
+    const size_t noise = i % 5;
+    for (size_t n = 0; n < noise; n++)
+    {
+      stream.push_back(300 + rng() % 3000);
+      stream.push_back(-static_cast<int32_t>(300 + rng() % 3000));
+    }
+    const int repeats = 1 + i % 3;
+    for (int r = 0; r < repeats; r++)
+      stream.insert(stream.end(), timings.begin(), timings.end());
+    for (int32_t &timing : stream)
+      timing += static_cast<int32_t>(rng() % 101) - 50;
+
+    Decoder decoder;
+    std::vector<size_t> ends;
+    for (size_t j = 0; j < stream.size(); j++)
+    {
+      if (decoder.feed(stream[j]) != Decoder::Result::FRAME)
+        continue;
+      ends.push_back(j);
+      GreeFrame decoded;
+      for (uint8_t b = 0; b < 8; b++)
+        decoded.set_byte(b, decoder.get_bytes()[b]);
+      ASSERT_EQ(decoded.raw(), frame.raw());
+    }
+    // Each frame is reported on its last bit, before its trailing mark and space arrive
+    ASSERT_EQ(ends.size(), size_t(repeats));
+    for (int r = 0; r < repeats; r++)
+      EXPECT_EQ(ends[r], 2 * noise + r * GREE_FRAME_ITEMS + GREE_FRAME_ITEMS - 3);
+  }
+}
+
+TYPED_TEST(GreeCodecTest, StreamDecoderReportsWhereAFrameBreaks)
+{
+  using Codec = GreeCodec<TypeParam::MODEL>;
+  using Decoder = GreeStreamDecoder<typename Codec::Layout>;
+  const GreeFrame frame = encode_state(GreeState{});
+  GreeFrameTimings timings;
+  Codec::encode_frame(frame, timings);
+  const struct
+  {
+    size_t index;
+    GreeDecodeStage stage;
+  } damages[] = {
+      {1, GreeDecodeStage::HEADER},
+      {2 + 21, GreeDecodeStage::BLOCK_1},
+      {2 + 64 + 3, GreeDecodeStage::FOOTER},
+      {GREE_MESSAGE_SPACE_INDEX, GreeDecodeStage::MESSAGE_SPACE},
+      {GREE_MESSAGE_SPACE_INDEX + 40, GreeDecodeStage::BLOCK_2},
+  };
+  for (const auto &damage : damages)
+  {
+    // A damaged first copy, then an intact repeat
+    std::vector<int32_t> stream(timings.begin(), timings.end());
+    stream[damage.index] = stream[damage.index] > 0 ? 100 : -100;
+    stream.insert(stream.end(), timings.begin(), timings.end());
+
+    Decoder decoder;
+    size_t errors = 0;
+    size_t frames = 0;
+    for (size_t i = 0; i < stream.size(); i++)
+    {
+      const auto result = decoder.feed(stream[i]);
+      if (result == Decoder::Result::ERROR && errors++ == 0)
+      {
+        EXPECT_EQ(i, damage.index);
+        EXPECT_EQ(decoder.get_error(), damage.stage) << "damaged at " << damage.index;
+      }
+      if (result == Decoder::Result::FRAME)
+      {
+        frames++;
+        GreeFrame decoded;
+        for (uint8_t b = 0; b < 8; b++)
+          decoded.set_byte(b, decoder.get_bytes()[b]);
+        EXPECT_EQ(decoded.raw(), frame.raw());
+      }
+    }
+    EXPECT_GE(errors, 1u);
+    EXPECT_EQ(frames, 1u) << "damaged at " << damage.index;
+  }
+}
+
+TYPED_TEST(GreeCodecTest, StreamDecoderDropsNoiseWithinAFewSymbols)
+{
+  using Codec = GreeCodec<TypeParam::MODEL>;
+  using Decoder = GreeStreamDecoder<typename Codec::Layout>;
+  std::mt19937_64 rng(1);
+  Decoder decoder;
+  size_t frames = 0;
+  size_t run = 0;
+  size_t longest_run = 0;
+  for (int i = 0; i < 100000; i++)
+  {
+    const int32_t length = 200 + rng() % 10000;
+    switch (decoder.feed(i % 2 ? -length : length))
+    {
+    case Decoder::Result::MORE:
+      longest_run = std::max(longest_run, ++run);
+      break;
+    case Decoder::Result::FRAME:
+      frames++;
+      break;
+    case Decoder::Result::ERROR:
+      run = 0;
+      break;
+    }
+  }
+  EXPECT_EQ(frames, 0u);
+  EXPECT_LE(longest_run, 4u);
+}
+
+TYPED_TEST(GreeCodecTest, StreamDecoderHonoursTheReceiverTolerance)
+{
+  using Codec = GreeCodec<TypeParam::MODEL>;
+  using Decoder = GreeStreamDecoder<typename Codec::Layout>;
+  const GreeFrame frame = encode_state(GreeState{});
+  GreeFrameTimings timings;
+  Codec::encode_frame(frame, timings);
+  // Marks 200 us long: out of 25% of a bit mark, within a 250 us time tolerance
+  for (int32_t &timing : timings)
+  {
+    if (timing > 0)
+      timing += 200;
+  }
+
+  auto frames = [&](Decoder decoder) {
+    size_t count = 0;
+    for (int32_t timing : timings)
+      count += decoder.feed(timing) == Decoder::Result::FRAME;
+    return count;
+  };
+  EXPECT_EQ(frames(Decoder()), 0u);
+  EXPECT_EQ(frames(Decoder(GreeTolerance{0, 250})), 1u);
+}
+
+TEST(GreeCodecTest, ClassifiesTheTimingVariant)
+{
+  auto classify = [](auto codec) {
+    VectorSink transmitter;
+    decltype(codec)::encode(encode_state(GreeState{}), transmitter, 2);
+    const std::vector<int32_t> capture = receive(transmitter.timings);
+    GreeIRModel model = GreeIRModel::AUTO;
+    EXPECT_TRUE(gree_classify(capture.data(), capture.size(), model));
+    return model;
+  };
+  EXPECT_EQ(classify(GreeCodec<GreeIRModel::GENERIC>{}), GreeIRModel::GENERIC);
+  EXPECT_EQ(classify(GreeCodec<GreeIRModel::YAC1FB9>{}), GreeIRModel::YAC1FB9);
+  EXPECT_EQ(classify(GreeCodec<GreeIRModel::YAW1F>{}), GreeIRModel::YAW1F);
+}
+
+TEST(GreeCodecTest, KelvinatorRoundTrips)
+{
+  std::mt19937_64 rng(1);
+  for (int i = 0; i < 10000; i++)
+  {
+    uint8_t bytes[16];
+    for (uint8_t &byte : bytes)
+      byte = rng();
+    GreeKelvinatorCodec::update_checksum(bytes);
+    GreeKelvinatorCodec::Timings timings;
+    GreeKelvinatorCodec::encode(bytes, timings.data());
+    GreePulseSource source(timings.data(), timings.size() - 1);
+    uint8_t decoded[16];
+    ASSERT_EQ(GreeKelvinatorCodec::decode(source, decoded), GreeDecodeStage::OK);
+    ASSERT_TRUE(GreeKelvinatorCodec::is_checksum_valid(decoded));
+    ASSERT_EQ(0, std::memcmp(bytes, decoded, sizeof(bytes)));
+  }
+}
+
+TEST(GreeCodecTest, KelvinatorStreamDecodes)
+{
+  using Decoder =
+      GreeStreamDecoder<GreePulseDistanceLayout<GreeKelvinatorTiming, 16, 2 * GreeKelvinatorTiming::MESSAGE_SPACE>>;
+  std::mt19937_64 rng(1);
+  for (int i = 0; i < 1000; i++)
+  {
+    uint8_t bytes[16];
+    for (uint8_t &byte : bytes)
+      byte = rng();
+    GreeKelvinatorCodec::update_checksum(bytes);
+    GreeKelvinatorCodec::Timings timings;
+    GreeKelvinatorCodec::encode(bytes, timings.data());
+    Decoder decoder;
+    size_t frames = 0;
+    for (int32_t timing : timings)
+    {
+      if (decoder.feed(timing) != Decoder::Result::FRAME)
+        continue;
+      frames++;
+      ASSERT_EQ(0, std::memcmp(bytes, decoder.get_bytes(), sizeof(bytes)));
+    }
+    ASSERT_EQ(frames, 1u);
+  }
+}
@@ -0,0 +1,344 @@
+// Replays captures through the receive path the component runs (prefilter, then a repeated
+// decode) with optional noise injected, and reports the decode rate and per-frame latency.
+//
+//   ./gree_replay [options] [FILE...]
+//
+// FILE holds logged captures: the output of dump_captures(), or remote_receiver's
+// "Received Raw:" dumps, with or without the log prefix. "-" reads stdin. Without a file,
+// synthetic captures of random climate states are replayed.
+//
+//   --model NAME        GENERIC, YAW1F, YBOFB, YAC1FB9, YT1F or AUTO (default GENERIC)
+//   --tolerance PCT     receiver tolerance in percent (default 25)
+//   --time-tolerance US receiver tolerance in microseconds, instead of a percentage
+//   --calibration M,S,J a learned calibration: mark and space bias and jitter, in microseconds
+//   --runs N            replays of each capture, each with fresh noise (default 1)
+//   --jitter US         standard deviation of Gaussian jitter added to every timing
+//   --mark-skew US      added to every mark, as a receiver that stretches them would
+//   --space-skew US     added to every space
+//   --glitch RATE       share of timings replaced by a 20-200 us glitch
+//   --frames N          synthetic captures (default 1000)
+//   --repeat N          copies per synthetic capture (default 2)
+//   --seed N            noise seed (default 1)
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gree_codec.h"
+
+using namespace esphome::greeir;
+
+namespace
+{
+
+  struct Options
+  {
+    GreeIRModel model{GreeIRModel::GENERIC};
+    GreeTolerance tolerance{};
+    GreeCalibration calibration{};
+    uint32_t runs{1};
+    double jitter{0};
+    int32_t mark_skew{0};
+    int32_t space_skew{0};
+    double glitch{0};
+    uint32_t frames{1000};
+    uint8_t repeat{2};
+    uint64_t seed{1};
+    std::vector<std::string> files;
+  };
+
+  /// Keep the timings of every capture in `in`. A capture starts on a dump_captures() header or
+  /// a "Raw:" line; the lines of timings after it continue it.
+  void parse_captures(std::istream &in, std::vector<std::vector<int32_t>> &captures)
+  {
+    std::string line;
+    bool open = false;
+    while (std::getline(in, line))
+    {
+      // Drop the "[12:00:00][I][greeir:123]:" log prefix, whose numbers aren't timings
+      const size_t prefix = line.rfind("]:");
+      std::string text = prefix == std::string::npos ? line : line.substr(prefix + 2);
+      const size_t raw = text.find("Raw:");
+      if (text.find("Capture ") != std::string::npos && text.find("timings:") != std::string::npos)
+      {
+        captures.emplace_back();
+        open = true;
+        continue;
+      }
+      if (raw != std::string::npos)
+      {
+        captures.emplace_back();
+        open = true;
+        text = text.substr(raw + 4);
+      }
+      if (!open)
+        continue;
+      // Anything but a list of timings ends the capture
+      if (text.find_first_not_of("0123456789-, \t\r") != std::string::npos)
+      {
+        open = false;
+        continue;
+      }
+
+      const char *p = text.c_str();
+      while (*p != '\0')
+      {
+        char *end;
+        const long value = std::strtol(p, &end, 10);
+        if (end == p)
+        {
+          p++;
+          continue;
+        }
+        captures.back().push_back(static_cast<int32_t>(value));
+        p = end;
+      }
+    }
+    captures.erase(std::remove_if(captures.begin(), captures.end(), [](const auto &c) { return c.empty(); }),
+                   captures.end());
+  }
+
+  /// Captures of random climate states as the receiver hands them over: `repeat` copies, less
+  /// the trailing space that the idle timeout cuts off.
+  void synthesize_captures(const Options &options, std::vector<std::vector<int32_t>> &captures)
+  {
+    std::mt19937_64 rng(options.seed);
+    const GreeIRModel model = options.model == GreeIRModel::AUTO ? GreeIRModel::GENERIC : options.model;
+    for (uint32_t i = 0; i < options.frames; i++)
+    {
+      GreeState state;
+      state.power = rng() & 1;
+      state.mode = rng() % 5;
+      state.fan = rng() % 4;
+      state.temperature = GREE_TEMP_MIN + rng() % (GREE_TEMP_MAX - GREE_TEMP_MIN + 1);
+      state.swing_v = rng() % 12;
+      state.swing_h = rng() % 7;
+      state.sleep = rng() & 1;
+      const GreeFrame frame = encode_state(state);
+      GreeFrameTimings timings;
+      gree_with_codec(model, [&](auto codec) { decltype(codec)::encode_frame(frame, timings); });
+      std::vector<int32_t> capture;
+      for (uint8_t r = 0; r < options.repeat; r++)
+        capture.insert(capture.end(), timings.begin(), timings.end());
+      capture.pop_back();
+      captures.push_back(std::move(capture));
+    }
+  }
+
+  /// `capture` as another receiver might have measured it.
+  void add_noise(const Options &options, std::mt19937_64 &rng, std::vector<int32_t> &capture)
+  {
+    std::normal_distribution<double> jitter(0, options.jitter);
+    std::uniform_real_distribution<double> chance(0, 1);
+    std::uniform_int_distribution<int32_t> glitch(20, 200);
+    for (int32_t &timing : capture)
+    {
+      const bool mark = timing > 0;
+      int32_t length = mark ? timing : -timing;
+      if (options.glitch > 0 && chance(rng) < options.glitch)
+        length = glitch(rng);
+      else
+        length += (mark ? options.mark_skew : options.space_skew) +
+                  (options.jitter > 0 ? static_cast<int32_t>(std::lround(jitter(rng))) : 0);
+      length = std::max(length, 1);
+      timing = mark ? length : -length;
+    }
+  }
+
+  struct Result
+  {
+    bool matched{false};
+    GreeDecodeStage stage{GreeDecodeStage::HEADER};
+    bool checksum_valid{false};
+  };
+
+  /// The component's on_receive() up to a decoded frame, without the ESPHome parts.
+  Result receive(const Options &options, const std::vector<int32_t> &capture)
+  {
+    Result result;
+    const GreeCalibration &calibration = options.calibration;
+    const bool learned = calibration.jitter > 0;
+    const GreeTolerance prefilter =
+        learned ? options.tolerance.merge(gree_learned_tolerance(calibration)) : options.tolerance;
+    GreeIRModel model = options.model;
+    if (model == GreeIRModel::AUTO)
+      result.matched = gree_classify(capture.data(), capture.size(), model, prefilter, calibration);
+    else
+      result.matched = gree_with_codec(model, [&](auto codec) {
+        return decltype(codec)::matches(capture.data(), capture.size(), prefilter, calibration);
+      });
+    if (!result.matched)
+      return result;
+
+    // Learned windows first, then the receiver's tolerance
+    auto decode = [&](GreeTolerance tolerance, GreeFrame &frame) {
+      GreePulseSource source(capture.data(), capture.size(), tolerance);
+      source.set_calibration(calibration);
+      return gree_with_codec(model, [&](auto codec) { return decltype(codec)::decode_repeated(source, frame); });
+    };
+    GreeFrame frame;
+    result.stage = decode(learned ? gree_learned_tolerance(calibration) : options.tolerance, frame);
+    if (result.stage != GreeDecodeStage::OK && learned)
+      result.stage = decode(options.tolerance, frame);
+    result.checksum_valid = result.stage == GreeDecodeStage::OK && frame.is_checksum_valid();
+    return result;
+  }
+
+  bool parse_model(const char *name, GreeIRModel &model)
+  {
+    for (GreeIRModel candidate : {GreeIRModel::GENERIC, GreeIRModel::YAW1F, GreeIRModel::YBOFB, GreeIRModel::YAC1FB9,
+                                  GreeIRModel::YT1F, GreeIRModel::AUTO})
+    {
+      if (strcasecmp(name, gree_model_to_string(candidate)) == 0)
+      {
+        model = candidate;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool parse_options(int argc, char **argv, Options &options)
+  {
+    for (int i = 1; i < argc; i++)
+    {
+      const std::string arg = argv[i];
+      if (arg.size() < 2 || arg.compare(0, 2, "--") != 0)
+      {
+        options.files.push_back(arg);
+        continue;
+      }
+      if (i + 1 >= argc)
+        return false;
+      const char *value = argv[++i];
+      if (arg == "--model")
+      {
+        if (!parse_model(value, options.model))
+          return false;
+      }
+      else if (arg == "--tolerance")
+        options.tolerance = GreeTolerance{static_cast<uint32_t>(std::atoi(value)), 0};
+      else if (arg == "--time-tolerance")
+        options.tolerance = GreeTolerance{0, static_cast<uint32_t>(std::atoi(value))};
+      else if (arg == "--calibration")
+      {
+        int mark, space, jitter;
+        if (std::sscanf(value, "%d,%d,%d", &mark, &space, &jitter) != 3 || jitter < 0)
+          return false;
+        options.calibration.mark_bias = mark;
+        options.calibration.space_bias = space;
+        options.calibration.jitter = jitter;
+      }
+      else if (arg == "--runs")
+        options.runs = std::max(1, std::atoi(value));
+      else if (arg == "--jitter")
+        options.jitter = std::atof(value);
+      else if (arg == "--mark-skew")
+        options.mark_skew = std::atoi(value);
+      else if (arg == "--space-skew")
+        options.space_skew = std::atoi(value);
+      else if (arg == "--glitch")
+        options.glitch = std::atof(value);
+      else if (arg == "--frames")
+        options.frames = std::atoi(value);
+      else if (arg == "--repeat")
+        options.repeat = std::max(1, std::min(std::atoi(value), 100));
+      else if (arg == "--seed")
+        options.seed = std::strtoull(value, nullptr, 10);
+      else
+        return false;
+    }
+    return true;
+  }
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  Options options;
+  if (!parse_options(argc, argv, options))
+  {
+    std::fprintf(stderr, "usage: %s [--model NAME] [--tolerance PCT | --time-tolerance US] [--calibration M,S,J]\n"
+                         "       [--runs N] [--jitter US] [--mark-skew US] [--space-skew US] [--glitch RATE] [--frames N] [--repeat N]\n"
+                         "       [--seed N] [FILE...]\n",
+                 argv[0]);
+    return 2;
+  }
+
+  std::vector<std::vector<int32_t>> captures;
+  for (const std::string &file : options.files)
+  {
+    if (file == "-")
+    {
+      parse_captures(std::cin, captures);
+      continue;
+    }
+    std::ifstream in(file);
+    if (!in)
+    {
+      std::fprintf(stderr, "cannot read %s\n", file.c_str());
+      return 1;
+    }
+    parse_captures(in, captures);
+  }
+  if (options.files.empty())
+    synthesize_captures(options, captures);
+  if (captures.empty())
+  {
+    std::fprintf(stderr, "no captures found\n");
+    return 1;
+  }
+
+  std::mt19937_64 rng(options.seed);
+  std::vector<double> latencies_us;
+  size_t matched = 0;
+  size_t decoded = 0;
+  size_t valid = 0;
+  size_t stages[static_cast<size_t>(GreeDecodeStage::BLOCK_2) + 1]{};
+  std::vector<int32_t> noisy;
+  for (uint32_t run = 0; run < options.runs; run++)
+  {
+    for (const auto &capture : captures)
+    {
+      noisy = capture;
+      add_noise(options, rng, noisy);
+      const auto start = std::chrono::steady_clock::now();
+      const Result result = receive(options, noisy);
+      latencies_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+
+      if (!result.matched)
+        continue;
+      matched++;
+      stages[static_cast<size_t>(result.stage)]++;
+      decoded += result.stage == GreeDecodeStage::OK;
+      valid += result.checksum_valid;
+    }
+  }
+
+  const size_t total = latencies_us.size();
+  std::sort(latencies_us.begin(), latencies_us.end());
+  auto percentile = [&](double p) { return latencies_us[std::min(total - 1, static_cast<size_t>(p * total))]; };
+  auto share = [total](size_t count) { return 100.0 * count / total; };
+
+  std::printf("model %s, %zu captures x %" PRIu32 " runs\n", gree_model_to_string(options.model), captures.size(),
+              options.runs);
+  std::printf("prefilter accepted  %8zu  %6.2f%%\n", matched, share(matched));
+  std::printf("decoded             %8zu  %6.2f%%\n", decoded, share(decoded));
+  std::printf("checksum valid      %8zu  %6.2f%%\n", valid, share(valid));
+  for (size_t i = 1; i < sizeof(stages) / sizeof(stages[0]); i++)
+  {
+    if (stages[i] > 0)
+      std::printf("  failed at %-16s %zu\n", gree_decode_stage_to_string(static_cast<GreeDecodeStage>(i)), stages[i]);
+  }
+  std::printf("latency per capture: p50 %.2f us, p99 %.2f us, max %.2f us\n", percentile(0.5), percentile(0.99),
+              latencies_us.back());
+  return 0;
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+// Timing-at-a-time decoder for the Gree pulse layouts. The component decodes whole
+// captures with GreePulseDistanceCodec; this one is exercised by the codec tests only.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "gree_codec.h"
+
+namespace esphome
+{
+  namespace greeir
+  {
+
+    /// Resumable decoder for a `GreePulseDistanceLayout` that takes one timing at a time, so a
+    /// frame can be handled as soon as its last bit arrives and a stream that isn't one is
+    /// dropped within a few symbols. Timings are in RawTimings form (marks positive).
+    /// Kept with the tests until the component gets a source of single edges.
+    template <typename Layout>
+    class GreeStreamDecoder
+    {
+    public:
+      using Timing = typename Layout::Timing;
+
+      explicit GreeStreamDecoder(GreeTolerance tolerance = {}) : tolerance_(tolerance), windows_(tolerance) {}
+
+      enum class Result : uint8_t
+      {
+        /// The timing fits; more are needed.
+        MORE,
+        /// The timing completed a frame, available from get_bytes() until the next feed().
+        FRAME,
+        /// The timing doesn't fit. get_error() tells where; decoding restarts at the next header.
+        ERROR,
+      };
+
+      Result feed(int32_t timing)
+      {
+        const Result result = this->step_(timing);
+        if (result == Result::ERROR)
+        {
+          // The offending timing may itself start the next frame
+          this->reset();
+          if (timing > 0 && in_tolerance(timing, Timing::HEADER_MARK, this->tolerance_))
+            this->pos_ = 1;
+        }
+        return result;
+      }
+
+      void reset()
+      {
+        this->pos_ = 0;
+        this->section_ = 0;
+      }
+
+      const uint8_t *get_bytes() const { return this->bytes_.data(); }
+      GreeDecodeStage get_error() const { return this->error_; }
+
+    protected:
+      // Item positions within a section
+      static constexpr size_t BLOCK_1 = 2;
+      static constexpr size_t FOOTER = BLOCK_1 + 64;
+      static constexpr size_t MESSAGE_SPACE = FOOTER + Layout::FOOTER_SIZE * 2;
+      static constexpr size_t BLOCK_2 = MESSAGE_SPACE + 2;
+      static constexpr size_t SECTION_SPACE = BLOCK_2 + 64;
+      // After a frame: its trailing mark and space, which are skipped
+      static constexpr size_t TRAILER = SECTION_SPACE + 2;
+
+      Result fail_(GreeDecodeStage stage)
+      {
+        this->error_ = stage;
+        return Result::ERROR;
+      }
+
+      /// Validate a bit timing and, for a space, store the bit. Returns false if it doesn't fit.
+      bool bit_(int32_t timing, size_t index, uint8_t *byte)
+      {
+        if ((index & 1) == 0)
+          return this->windows_.is_mark(timing);
+        if (!this->windows_.is_space(-timing))
+          return false;
+        const uint8_t bit = 1 << ((index / 2) % 8);
+        *byte = -timing > this->windows_.space_threshold ? (*byte | bit) : (*byte & ~bit);
+        return true;
+      }
+
+      Result step_(int32_t timing)
+      {
+        const size_t pos = this->pos_++;
+        uint8_t *section = this->bytes_.data() + this->section_ * 8;
+
+        if (pos == 0)
+          return in_tolerance(timing, Timing::HEADER_MARK, this->tolerance_) ? Result::MORE : this->fail_(GreeDecodeStage::HEADER);
+        if (pos == 1)
+          return in_tolerance(-timing, Timing::HEADER_SPACE, this->tolerance_) ? Result::MORE : this->fail_(GreeDecodeStage::HEADER);
+        if (pos < FOOTER)
+        {
+          const size_t index = pos - BLOCK_1;
+          return this->bit_(timing, index, section + index / 16) ? Result::MORE : this->fail_(GreeDecodeStage::BLOCK_1);
+        }
+        if (pos < MESSAGE_SPACE)
+        {
+          const size_t index = pos - FOOTER;
+          if (index == 0)
+            this->footer_ = 0;
+          if (!this->bit_(timing, index, &this->footer_))
+            return this->fail_(GreeDecodeStage::FOOTER);
+          if (pos + 1 == MESSAGE_SPACE && this->footer_ != Layout::FOOTER)
+            return this->fail_(GreeDecodeStage::FOOTER);
+          return Result::MORE;
+        }
+        if (pos == MESSAGE_SPACE)
+          return in_tolerance(timing, Timing::BIT_MARK, this->tolerance_) ? Result::MORE : this->fail_(GreeDecodeStage::MESSAGE_SPACE);
+        if (pos == MESSAGE_SPACE + 1)
+          return in_tolerance(-timing, Timing::MESSAGE_SPACE, this->tolerance_) ? Result::MORE : this->fail_(GreeDecodeStage::MESSAGE_SPACE);
+        if (pos < SECTION_SPACE)
+        {
+          const size_t index = pos - BLOCK_2;
+          if (!this->bit_(timing, index, section + 4 + index / 16))
+            return this->fail_(GreeDecodeStage::BLOCK_2);
+          if (pos + 1 < SECTION_SPACE)
+            return Result::MORE;
+          if (this->section_ + 1 < Layout::SECTIONS)
+            return Result::MORE;
+          this->pos_ = TRAILER;
+          this->section_ = 0;
+          return Result::FRAME;
+        }
+        if (pos == SECTION_SPACE)
+          return in_tolerance(timing, Timing::BIT_MARK, this->tolerance_) ? Result::MORE : this->fail_(GreeDecodeStage::HEADER);
+        if (pos == SECTION_SPACE + 1)
+        {
+          if (!in_tolerance(-timing, Layout::SECTION_SPACE, this->tolerance_))
+            return this->fail_(GreeDecodeStage::HEADER);
+          this->pos_ = 0;
+          this->section_++;
+          return Result::MORE;
+        }
+
+        // Trailer of the previous frame: a bit mark and whatever space follows it
+        if (pos == TRAILER && timing > 0 && in_tolerance(timing, Timing::BIT_MARK, this->tolerance_))
+          return Result::MORE;
+        this->pos_ = 0;
+        if (pos == TRAILER + 1 && timing < 0)
+          return Result::MORE;
+        return this->step_(timing);
+      }
+
+      GreeTolerance tolerance_;
+      GreeBitWindows<Timing> windows_;
+      std::array<uint8_t, Layout::BYTES> bytes_{};
+      size_t pos_{0};
+      size_t section_{0};
+      uint8_t footer_{0};
+      GreeDecodeStage error_{GreeDecodeStage::OK};
+    };
+
+  } // namespace greeir
+} // namespace esphome
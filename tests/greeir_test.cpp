@@ -0,0 +1,612 @@
+// The ESPHome adapter on the host, against the test doubles under doubles/: a simulated
+// clock and scheduler, and a transmitter that takes as long as its pulses are on the air.
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "automation.h"
+#include "greeir.h"
+
+using namespace esphome;
+using namespace esphome::greeir;
+
+namespace
+{
+
+  /// Transmitter that records every burst and blocks, in simulated time, for its airtime.
+  class MockTransmitter : public remote_base::RemoteTransmitterBase
+  {
+  public:
+    struct Burst
+    {
+      remote_base::RawTimings timings;
+      uint32_t send_times;
+      uint64_t start_us;
+    };
+
+    /// Copies of a frame sent in all bursts.
+    uint32_t copies() const
+    {
+      uint32_t copies = 0;
+      for (const auto &burst : this->bursts)
+        copies += burst.send_times;
+      return copies;
+    }
+
+    std::vector<Burst> bursts;
+
+  protected:
+    void send_internal(uint32_t send_times, uint32_t send_wait) override
+    {
+      uint64_t airtime = 0;
+      for (int32_t timing : this->temp_.get_data())
+        airtime += std::abs(timing);
+      this->bursts.push_back(Burst{this->temp_.get_data(), send_times, sim::now_us});
+      sim::advance_us(airtime * send_times + uint64_t(send_wait) * (send_times - 1));
+    }
+  };
+
+  /// Airtime of one frame, in microseconds. All ones is the longest a frame can take.
+  uint64_t frame_airtime(GreeFrame frame = GreeFrame(UINT64_MAX))
+  {
+    GreeFrameTimings timings;
+    GreeCodec<GreeIRModel::GENERIC>::encode_frame(frame, timings);
+    uint64_t airtime = 0;
+    for (int32_t timing : timings)
+      airtime += std::abs(timing);
+    return airtime;
+  }
+
+  class GreeIRClimateTest : public testing::Test
+  {
+  protected:
+    // Application::loop() runs at most every 16 ms when there is nothing to do
+    static const uint32_t LOOP_INTERVAL_MS = 16;
+
+    void SetUp() override
+    {
+      sim::clear_scheduler();
+      sim::now_us = 1000000;
+      global_preferences->flash.clear();
+      global_preferences->rtc.clear();
+      global_preferences->slots_made = 0;
+    }
+
+    /// Run `f` as one piece of main-loop work and note how long it held the loop.
+    template <typename F>
+    void run_blocking(F &&f)
+    {
+      const uint64_t start = sim::now_us;
+      f();
+      this->longest_block_us = std::max(this->longest_block_us, sim::now_us - start);
+    }
+
+    /// One main-loop iteration: due scheduler callbacks, then the component's loop().
+    void iterate(Component &component)
+    {
+      this->run_blocking([&]() {
+        sim::run_scheduler();
+        component.loop();
+      });
+      sim::advance_ms(LOOP_INTERVAL_MS);
+    }
+
+    void run_for(Component &component, uint32_t ms)
+    {
+      const uint64_t end = sim::now_us + uint64_t(ms) * 1000;
+      while (sim::now_us < end)
+        this->iterate(component);
+    }
+
+    uint64_t longest_block_us{0};
+  };
+
+} // namespace
+
+TEST_F(GreeIRClimateTest, AsyncTransmitBoundsTheLongestLoopBlock)
+{
+  const uint8_t repeat = 100;
+  uint64_t longest[2];
+  for (bool async : {false, true})
+  {
+    SetUp();
+    this->longest_block_us = 0;
+    MockTransmitter transmitter;
+    GreeIRModelClimate<GreeIRModel::GENERIC> climate;
+    climate.set_transmitter(&transmitter);
+    climate.set_repeat(repeat);
+    climate.set_async_transmit(async);
+    int completions = 0;
+    climate.add_on_transmit_complete_callback([&]() { completions++; });
+    climate.setup();
+
+    this->run_blocking([&]() { climate.make_call().set_mode(climate::CLIMATE_MODE_COOL).perform(); });
+    for (int i = 0; i < 1000 && climate.is_transmitting(); i++)
+      this->iterate(climate);
+
+    EXPECT_FALSE(climate.is_transmitting());
+    EXPECT_EQ(transmitter.copies(), repeat);
+    EXPECT_EQ(completions, 1);
+    longest[async] = this->longest_block_us;
+    std::printf("%s transmit, repeat %u: loop blocked for at most %.1f ms\n", async ? "async" : "sync", repeat,
+                this->longest_block_us / 1000.0);
+  }
+
+  EXPECT_GE(longest[false], repeat * frame_airtime(GreeFrame()));
+  EXPECT_LE(longest[true], frame_airtime());
+}
+
+TEST_F(GreeIRClimateTest, NewerFrameReplacesTheRestOfAnAsyncBurst)
+{
+  MockTransmitter transmitter;
+  GreeIRModelClimate<GreeIRModel::GENERIC> climate;
+  climate.set_transmitter(&transmitter);
+  climate.set_repeat(10);
+  climate.set_async_transmit(true);
+  climate.setup();
+
+  climate.make_call().set_mode(climate::CLIMATE_MODE_COOL).perform();
+  this->iterate(climate);
+  this->iterate(climate);
+  climate.make_call().set_mode(climate::CLIMATE_MODE_HEAT).perform();
+  this->run_for(climate, 5000);
+
+  ASSERT_EQ(transmitter.copies(), 3u + 10u);
+  EXPECT_NE(transmitter.bursts[2].timings, transmitter.bursts[3].timings);
+  EXPECT_EQ(transmitter.bursts[3].timings, transmitter.bursts.back().timings);
+}
+
+namespace
+{
+
+  /// Deliver `timings` to `climate` as remote_receiver would, with its default 25% tolerance.
+  bool receive(GreeIRClimate &climate, const remote_base::RawTimings &timings)
+  {
+    remote_base::RemoteReceiverListener &listener = climate;
+    return listener.on_receive(remote_base::RemoteReceiveData(timings, 25, remote_base::TOLERANCE_MODE_PERCENTAGE));
+  }
+
+  /// Capture of `repeat` copies of `frame`, less the trailing space the receiver never sees.
+  remote_base::RawTimings capture(GreeFrame frame, uint8_t repeat = 1)
+  {
+    GreeFrameTimings copy;
+    GreeCodec<GreeIRModel::GENERIC>::encode_frame(frame, copy);
+    remote_base::RawTimings timings;
+    for (uint8_t i = 0; i < repeat; i++)
+    {
+      for (int32_t timing : copy)
+        timings.push_back(timing);
+    }
+    timings.pop_back();
+    return timings;
+  }
+
+  GreeFrame cool_frame(uint8_t temperature)
+  {
+    GreeState state;
+    state.power = true;
+    state.mode = GREE_MODE_COOL;
+    state.temperature = temperature;
+    return encode_state(state);
+  }
+
+} // namespace
+
+TEST_F(GreeIRClimateTest, CountsFramesDecodedOnlyOnceTheirChecksumPasses)
+{
+  MockTransmitter transmitter;
+  GreeIRModelClimate<GreeIRModel::GENERIC> climate;
+  sensor::Sensor decoded;
+  sensor::Sensor checksum_errors;
+  climate.set_transmitter(&transmitter);
+  climate.set_diagnostic_sensor(GreeDiagnostic::FRAMES_DECODED, &decoded);
+  climate.set_diagnostic_sensor(GreeDiagnostic::CHECKSUM_ERRORS, &checksum_errors);
+  climate.set_diagnostics_interval(1000);
+  climate.setup();
+
+  EXPECT_TRUE(receive(climate, capture(cool_frame(22))));
+  GreeFrame corrupt = cool_frame(24);
+  corrupt.set(GreeFrame::SUM, corrupt.get(GreeFrame::SUM) ^ 1);
+  receive(climate, capture(corrupt));
+  this->run_for(climate, 1100);
+
+  EXPECT_EQ(decoded.state, 1.0f);
+  EXPECT_EQ(checksum_errors.state, 1.0f);
+}
+
+TEST_F(GreeIRClimateTest, CountsIFeelReportsAsTransmitted)
+{
+  MockTransmitter transmitter;
+  GreeIRModelClimate<GreeIRModel::GENERIC> climate;
+  sensor::Sensor room;
+  sensor::Sensor transmitted;
+  sensor::Sensor airtime;
+  climate.set_transmitter(&transmitter);
+  climate.set_sensor(&room);
+  climate.set_ifeel(0.5f, 0, 0);
+  climate.set_diagnostic_sensor(GreeDiagnostic::FRAMES_TRANSMITTED, &transmitted);
+  climate.set_diagnostic_sensor(GreeDiagnostic::AIRTIME, &airtime);
+  climate.set_diagnostics_interval(1000);
+  climate.setup();
+
+  climate.make_call().set_mode(climate::CLIMATE_MODE_COOL).perform();
+  room.publish_state(21.0f);
+  this->run_for(climate, 1100);
+
+  // The state frame, the report sent with the reading and the one sent after power-on
+  ASSERT_EQ(transmitter.bursts.size(), 3u);
+  uint64_t total = 0;
+  for (const auto &burst : transmitter.bursts)
+  {
+    for (int32_t timing : burst.timings)
+      total += std::abs(timing);
+  }
+  EXPECT_EQ(transmitted.state, 3.0f);
+  EXPECT_EQ(airtime.state, static_cast<float>(total / 1000));
+}
+
+TEST_F(GreeIRClimateTest, DecodesPastTheReceiverToleranceOnceCalibrated)
+{
+  MockTransmitter transmitter;
+  GreeIRModelClimate<GreeIRModel::GENERIC> climate;
+  climate.set_transmitter(&transmitter);
+  climate.set_calibration(true);
+  climate.setup();
+
+  // Marks 200 us long are outside 25% of a bit mark until the skew is taken off them
+  auto skewed = [](GreeFrame frame, int32_t mark_skew) {
+    remote_base::RawTimings timings = capture(frame, 2);
+    for (size_t i = 0; i < timings.size(); i++)
+      timings[i] += (timings[i] > 0 ? mark_skew : 100) + (i / 2 % 2 ? 10 : -10);
+    return timings;
+  };
+  EXPECT_FALSE(receive(climate, skewed(cool_frame(25), 200)));
+  for (int i = 0; i < 40; i++)
+    ASSERT_TRUE(receive(climate, skewed(cool_frame(22), 100)));
+  EXPECT_TRUE(receive(climate, skewed(cool_frame(25), 200)));
+  EXPECT_EQ(climate.target_temperature, 25.0f);
+
+  // Saved within a few microseconds of where the average settles, jitter included
+  GreeCalibration saved;
+  size_t slots = 0;
+  for (const auto &slot : global_preferences->flash)
+  {
+    if (slot.second.size() == sizeof(saved))
+    {
+      std::memcpy(&saved, slot.second.data(), sizeof(saved));
+      slots++;
+    }
+  }
+  ASSERT_EQ(slots, 1u);
+  EXPECT_NEAR(saved.mark_bias, 100, 15);
+  EXPECT_NEAR(saved.space_bias, -100, 15);
+  EXPECT_GT(saved.jitter, 0);
+}
+
+TEST_F(GreeIRClimateTest, GroupMembersIgnoreEchoesOfAWholeAsyncBurst)
+{
+  MockTransmitter transmitter;
+  GreeIRModelClimate<GreeIRModel::GENERIC> leader;
+  GreeIRModelClimate<GreeIRModel::GENERIC> member;
+  leader.set_transmitter(&transmitter);
+  leader.set_repeat(10);
+  leader.set_async_transmit(true);
+  leader.add_group_member(&member);
+  member.set_transmitter(&transmitter);
+  leader.setup();
+  member.setup();
+
+  leader.make_call().set_mode(climate::CLIMATE_MODE_COOL).perform();
+  remote_base::RawTimings echo = transmitter.bursts[0].timings;
+  echo.pop_back();
+  // Well past the first copy's window, with copies of the burst still on the air
+  for (int i = 0; i < 7; i++)
+    this->iterate(leader);
+  ASSERT_TRUE(leader.is_transmitting());
+  ASSERT_GT(sim::now_us - transmitter.bursts[0].start_us, (frame_airtime() + 250000) * 2);
+
+  const size_t published = member.publish_count;
+  EXPECT_TRUE(receive(member, echo));
+  EXPECT_EQ(member.publish_count, published);
+
+  // Once the burst is over, the same frame is the remote's again
+  this->run_for(leader, 1000);
+  ASSERT_FALSE(leader.is_transmitting());
+  EXPECT_TRUE(receive(member, echo));
+  EXPECT_EQ(member.publish_count, published + 1);
+}
+
+namespace
+{
+
+  /// Exposes the capture recorder.
+  class RecordingClimate : public GreeIRModelClimate<GreeIRModel::GENERIC>
+  {
+  public:
+    using GreeIRClimate::recorder_;
+  };
+
+} // namespace
+
+TEST_F(GreeIRClimateTest, OtherRemotesDontPushOutFailedCaptures)
+{
+  // An NEC frame: 9 ms header, then 562 us marks
+  remote_base::RawTimings foreign = {9000, -4500};
+  for (int i = 0; i < 32; i++)
+  {
+    foreign.push_back(562);
+    foreign.push_back(i % 3 ? -562 : -1687);
+  }
+  foreign.push_back(562);
+  remote_base::RawTimings damaged = capture(cool_frame(22));
+  damaged[2 * 40 + 1] = -3000;
+
+  for (bool record_rejected : {false, true})
+  {
+    MockTransmitter transmitter;
+    RecordingClimate climate;
+    climate.set_transmitter(&transmitter);
+    climate.set_record_captures(4);
+    climate.set_record_rejected(record_rejected);
+    climate.setup();
+
+    EXPECT_FALSE(receive(climate, damaged));
+    for (int i = 0; i < 10; i++)
+      EXPECT_FALSE(receive(climate, foreign));
+
+    if (record_rejected)
+    {
+      ASSERT_EQ(climate.recorder_->size(), 4u);
+      EXPECT_FALSE(climate.recorder_->get(0).matched);
+    }
+    else
+    {
+      ASSERT_EQ(climate.recorder_->size(), 1u);
+      EXPECT_TRUE(climate.recorder_->get(0).matched);
+      EXPECT_NE(climate.recorder_->get(0).stage, GreeDecodeStage::OK);
+    }
+  }
+}
+
+namespace
+{
+
+  /// The frame a burst carried.
+  GreeFrame sent_frame(const MockTransmitter::Burst &burst)
+  {
+    GreePulseSource source(burst.timings.data(), burst.timings.size());
+    GreeFrame frame;
+    EXPECT_EQ(GreeCodec<GreeIRModel::GENERIC>::decode(source, frame), GreeDecodeStage::OK);
+    return frame;
+  }
+
+} // namespace
+
+TEST_F(GreeIRClimateTest, FollowsTheTimerTheUnitIsRearmedWith)
+{
+  MockTransmitter transmitter;
+  GreeIRModelClimate<GreeIRModel::GENERIC> climate;
+  climate.set_transmitter(&transmitter);
+  climate.setup();
+  climate.make_call().set_mode(climate::CLIMATE_MODE_COOL).perform();
+  climate.set_timer(60);
+
+  // The change at 40 min carries the 20 min left as half an hour, so the unit fires at 70 min
+  this->run_for(climate, 40 * 60000);
+  climate.make_call().set_target_temperature(20).perform();
+  EXPECT_EQ(decode_state(sent_frame(transmitter.bursts.back())).timer, 30);
+  this->run_for(climate, 60000);
+  EXPECT_EQ(climate.get_timer_remaining(), 29u);
+  this->run_for(climate, 28 * 60000);
+  EXPECT_EQ(climate.mode, climate::CLIMATE_MODE_COOL);
+  this->run_for(climate, 2 * 60000);
+  EXPECT_EQ(climate.mode, climate::CLIMATE_MODE_OFF);
+}
+
+TEST_F(GreeIRClimateTest, KeepalivesDontMoveTheTimerExpiry)
+{
+  MockTransmitter transmitter;
+  GreeIRModelClimate<GreeIRModel::GENERIC> climate;
+  climate.set_transmitter(&transmitter);
+  climate.set_keepalive_interval(25 * 60000);
+  climate.setup();
+  climate.make_call().set_mode(climate::CLIMATE_MODE_COOL).perform();
+  climate.set_timer(60);
+  const size_t armed = transmitter.bursts.size();
+
+  // Re-arming at 25 and 50 min with the time left rounded up would put the expiry off forever
+  this->run_for(climate, 59 * 60000);
+  ASSERT_EQ(transmitter.bursts.size(), armed + 2);
+  for (size_t i = armed; i < transmitter.bursts.size(); i++)
+  {
+    const GreeState sent = decode_state(sent_frame(transmitter.bursts[i]));
+    EXPECT_TRUE(sent.power);
+    EXPECT_EQ(sent.timer, 0);
+  }
+  EXPECT_EQ(climate.get_timer_remaining(), 1u);
+  EXPECT_EQ(climate.mode, climate::CLIMATE_MODE_COOL);
+  this->run_for(climate, 2 * 60000);
+  EXPECT_EQ(climate.mode, climate::CLIMATE_MODE_OFF);
+}
+
+TEST_F(GreeIRClimateTest, SwitchingOffCancelsAnOffTimer)
+{
+  MockTransmitter transmitter;
+  GreeIRModelClimate<GreeIRModel::GENERIC> climate;
+  climate.set_transmitter(&transmitter);
+  climate.setup();
+  climate.make_call().set_mode(climate::CLIMATE_MODE_COOL).perform();
+  climate.set_timer(60);
+
+  // Still carrying the timer, the off frame would read as an on timer
+  this->run_for(climate, 10 * 60000);
+  climate.make_call().set_mode(climate::CLIMATE_MODE_OFF).perform();
+  const GreeState sent = decode_state(sent_frame(transmitter.bursts.back()));
+  EXPECT_FALSE(sent.power);
+  EXPECT_EQ(sent.timer, 0);
+  EXPECT_EQ(climate.get_timer_remaining(), 0u);
+
+  this->run_for(climate, 60 * 60000);
+  EXPECT_EQ(climate.mode, climate::CLIMATE_MODE_OFF);
+}
+
+TEST_F(GreeIRClimateTest, TimerActionRoundsShortDurationsUp)
+{
+  MockTransmitter transmitter;
+  GreeIRModelClimate<GreeIRModel::GENERIC> climate;
+  climate.set_transmitter(&transmitter);
+  climate.setup();
+  climate.make_call().set_mode(climate::CLIMATE_MODE_COOL).perform();
+
+  GreeSetTimerAction<> action;
+  action.set_parent(&climate);
+  action.set_duration(45000);
+  action.play();
+  EXPECT_EQ(climate.get_timer_remaining(), 30u);
+  EXPECT_EQ(decode_state(sent_frame(transmitter.bursts.back())).timer, 30);
+}
+
+TEST_F(GreeIRClimateTest, WakeFrameReusesOnePreferenceSlot)
+{
+  MockTransmitter transmitter;
+  {
+    GreeIRModelClimate<GreeIRModel::GENERIC> climate;
+    climate.set_transmitter(&transmitter);
+    climate.setup();
+    EXPECT_FALSE(climate.sent_wake_frame());
+    const size_t slots = global_preferences->slots_made;
+    auto call = climate.make_call();
+    call.set_mode(climate::CLIMATE_MODE_HEAT);
+    for (int i = 0; i < 10; i++)
+      climate.send_on_wake(call);
+    EXPECT_EQ(global_preferences->slots_made, slots);
+    EXPECT_TRUE(transmitter.bursts.empty());
+  }
+
+  // The next boot sends the stored frame once, and the one after finds it cleared
+  for (bool stored : {true, false})
+  {
+    transmitter.bursts.clear();
+    GreeIRModelClimate<GreeIRModel::GENERIC> climate;
+    climate.set_transmitter(&transmitter);
+    climate.setup();
+    EXPECT_EQ(climate.sent_wake_frame(), stored);
+    EXPECT_EQ(transmitter.bursts.size(), stored ? 1u : 0u);
+    if (stored)
+    {
+      EXPECT_EQ(climate.mode, climate::CLIMATE_MODE_HEAT);
+    }
+  }
+}
+
+TEST_F(GreeIRClimateTest, WakeFrameIsSentWholeWithAsyncTransmit)
+{
+  MockTransmitter transmitter;
+  {
+    GreeIRModelClimate<GreeIRModel::GENERIC> climate;
+    climate.set_transmitter(&transmitter);
+    climate.setup();
+    auto call = climate.make_call();
+    call.set_mode(climate::CLIMATE_MODE_COOL);
+    climate.send_on_wake(call);
+  }
+
+  // The node may sleep right after setup, before loop() could send the remaining copies
+  GreeIRModelClimate<GreeIRModel::GENERIC> climate;
+  climate.set_transmitter(&transmitter);
+  climate.set_async_transmit(true);
+  climate.set_repeat(5);
+  climate.setup();
+  ASSERT_TRUE(climate.sent_wake_frame());
+  ASSERT_EQ(transmitter.bursts.size(), 1u);
+  EXPECT_EQ(transmitter.bursts[0].send_times, 5u);
+  climate.loop();
+  EXPECT_EQ(transmitter.bursts.size(), 1u);
+}
+
+namespace
+{
+
+  template <GreeIRModel Model>
+  struct ModelTag
+  {
+    static constexpr GreeIRModel MODEL = Model;
+  };
+
+  template <typename Tag>
+  class GreeIRModelTest : public GreeIRClimateTest
+  {
+  };
+
+  /// Exposes the frame the entity's state encodes to.
+  template <GreeIRModel Model>
+  class StateClimate : public GreeIRModelClimate<Model>
+  {
+  public:
+    using GreeIRClimate::get_state_to_send;
+  };
+
+  using Models = testing::Types<ModelTag<GreeIRModel::GENERIC>, ModelTag<GreeIRModel::YAW1F>, ModelTag<GreeIRModel::YBOFB>,
+                                ModelTag<GreeIRModel::YAC1FB9>, ModelTag<GreeIRModel::YT1F>>;
+  TYPED_TEST_SUITE(GreeIRModelTest, Models);
+
+} // namespace
+
+TYPED_TEST(GreeIRModelTest, EveryClimateStateRoundTripsThroughTheComponent)
+{
+  // One entity sends every state its traits allow; a second, listening, must end up in it
+  MockTransmitter transmitter;
+  StateClimate<TypeParam::MODEL> sender;
+  StateClimate<TypeParam::MODEL> receiver;
+  sender.set_transmitter(&transmitter);
+  receiver.set_transmitter(&transmitter);
+  sender.setup();
+  receiver.setup();
+
+  const climate::ClimateMode modes[] = {climate::CLIMATE_MODE_OFF, climate::CLIMATE_MODE_HEAT_COOL,
+                                        climate::CLIMATE_MODE_COOL, climate::CLIMATE_MODE_HEAT,
+                                        climate::CLIMATE_MODE_DRY, climate::CLIMATE_MODE_FAN_ONLY};
+  const climate::ClimateFanMode fans[] = {climate::CLIMATE_FAN_AUTO, climate::CLIMATE_FAN_LOW,
+                                          climate::CLIMATE_FAN_MEDIUM, climate::CLIMATE_FAN_HIGH};
+  const climate::ClimateSwingMode swings[] = {climate::CLIMATE_SWING_OFF, climate::CLIMATE_SWING_VERTICAL,
+                                              climate::CLIMATE_SWING_HORIZONTAL, climate::CLIMATE_SWING_BOTH};
+  const climate::ClimatePreset presets[] = {climate::CLIMATE_PRESET_NONE, climate::CLIMATE_PRESET_SLEEP};
+  size_t states = 0;
+  for (auto mode : modes)
+    for (uint8_t temperature = GREE_TEMP_MIN; temperature <= GREE_TEMP_MAX; temperature++)
+      for (auto fan : fans)
+        for (auto swing : swings)
+          for (auto preset : presets)
+          {
+            const size_t bursts = transmitter.bursts.size();
+            sender.make_call()
+                .set_mode(mode)
+                .set_target_temperature(temperature)
+                .set_fan_mode(fan)
+                .set_swing_mode(swing)
+                .set_preset(preset)
+                .perform();
+            ASSERT_EQ(transmitter.bursts.size(), bursts + 1);
+
+            remote_base::RawTimings timings = transmitter.bursts.back().timings;
+            timings.pop_back();
+            ASSERT_TRUE(receive(receiver, timings));
+            ASSERT_EQ(receiver.mode, mode);
+            // An off frame leaves the rest of the state alone
+            if (mode != climate::CLIMATE_MODE_OFF)
+            {
+              ASSERT_EQ(receiver.target_temperature, temperature);
+              ASSERT_EQ(receiver.fan_mode.value(), fan);
+              ASSERT_EQ(receiver.swing_mode, swing);
+              ASSERT_EQ(receiver.preset.value(), preset);
+              // The receiver holds what the sender meant to send, so it has nothing to resend
+              ASSERT_EQ(receiver.get_state_to_send(), sender.get_state_to_send());
+            }
+            states++;
+          }
+  EXPECT_EQ(states, 6u * (GREE_TEMP_MAX - GREE_TEMP_MIN + 1) * 4 * 4 * 2);
+}